@@ -0,0 +1,184 @@
+#include "audioconvert.h"
+
+#include <cstdint>
+
+extern "C" {
+#include <libavutil/cpu.h>
+}
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define AUDIO_HAVE_X86 1
+#include <immintrin.h>
+#else
+#define AUDIO_HAVE_X86 0
+#endif
+
+// GCC/Clang(MinGW) 需要按函数开启指令集，MSVC 直接可用
+#if AUDIO_HAVE_X86 && (defined(__GNUC__) || defined(__clang__))
+#define AUDIO_TARGET_SSE2 __attribute__((target("sse2")))
+#define AUDIO_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define AUDIO_TARGET_SSE2
+#define AUDIO_TARGET_AVX2
+#endif
+
+namespace {
+
+template<typename T>
+void interleaveScalar(const uint8_t *const *planes, int channels, int samples, int start, T *dst)
+{
+    for (int c = 0; c < channels; c++) {
+        const T *src = reinterpret_cast<const T *>(planes[c]);
+        for (int i = start; i < samples; i++) {
+            dst[i * channels + c] = src[i];
+        }
+    }
+}
+
+#if AUDIO_HAVE_X86
+
+// 以下函数返回已处理的样本数，剩余部分由标量实现补齐
+AUDIO_TARGET_SSE2 int stereoFloatSse2(const float *l, const float *r, int samples, float *dst)
+{
+    int i = 0;
+    for (; i + 4 <= samples; i += 4) {
+        __m128 a = _mm_loadu_ps(l + i);
+        __m128 b = _mm_loadu_ps(r + i);
+        _mm_storeu_ps(dst + i * 2, _mm_unpacklo_ps(a, b));
+        _mm_storeu_ps(dst + i * 2 + 4, _mm_unpackhi_ps(a, b));
+    }
+    return i;
+}
+
+AUDIO_TARGET_SSE2 int stereoS16Sse2(const int16_t *l, const int16_t *r, int samples, int16_t *dst)
+{
+    int i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(l + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(r + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 2), _mm_unpacklo_epi16(a, b));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 2 + 8), _mm_unpackhi_epi16(a, b));
+    }
+    return i;
+}
+
+// AVX2 的 unpack 只在 128 位通道内交错，再用 permute2 把两半拼回顺序
+AUDIO_TARGET_AVX2 int stereoFloatAvx2(const float *l, const float *r, int samples, float *dst)
+{
+    int i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        __m256 a = _mm256_loadu_ps(l + i);
+        __m256 b = _mm256_loadu_ps(r + i);
+        __m256 lo = _mm256_unpacklo_ps(a, b);
+        __m256 hi = _mm256_unpackhi_ps(a, b);
+        _mm256_storeu_ps(dst + i * 2, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(dst + i * 2 + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+    return i;
+}
+
+AUDIO_TARGET_AVX2 int stereoS16Avx2(const int16_t *l, const int16_t *r, int samples, int16_t *dst)
+{
+    int i = 0;
+    for (; i + 16 <= samples; i += 16) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(l + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(r + i));
+        __m256i lo = _mm256_unpacklo_epi16(a, b);
+        __m256i hi = _mm256_unpackhi_epi16(a, b);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 2), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 2 + 16), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    return i;
+}
+
+#endif
+
+} // namespace
+
+PlanarInterleaver::PlanarInterleaver(Kernel kernel)
+    : m_kernel(kernel)
+{
+}
+
+PlanarInterleaver::Kernel PlanarInterleaver::detectKernel()
+{
+#if AUDIO_HAVE_X86
+    int flags = av_get_cpu_flags();
+    if (flags & AV_CPU_FLAG_AVX2) {
+        return Kernel::Avx2;
+    }
+    if (flags & AV_CPU_FLAG_SSE2) {
+        return Kernel::Sse2;
+    }
+#endif
+    return Kernel::Scalar;
+}
+
+const char *PlanarInterleaver::kernelName(Kernel kernel)
+{
+    switch (kernel) {
+    case Kernel::Avx2:
+        return "avx2";
+    case Kernel::Sse2:
+        return "sse2";
+    default:
+        return "scalar";
+    }
+}
+
+bool PlanarInterleaver::isSupported(AVSampleFormat srcFormat, AVSampleFormat dstFormat)
+{
+    return (srcFormat == AV_SAMPLE_FMT_FLTP && dstFormat == AV_SAMPLE_FMT_FLT)
+            || (srcFormat == AV_SAMPLE_FMT_S16P && dstFormat == AV_SAMPLE_FMT_S16);
+}
+
+bool PlanarInterleaver::interleave(const uint8_t *const *planes, int channels, int samples,
+                                   AVSampleFormat srcFormat, uint8_t *dst) const
+{
+    if (!planes || !dst || channels <= 0 || samples < 0) {
+        return false;
+    }
+
+    if (srcFormat == AV_SAMPLE_FMT_FLTP) {
+        float *out = reinterpret_cast<float *>(dst);
+        int done = 0;
+#if AUDIO_HAVE_X86
+        if (channels == 2) {
+            const float *l = reinterpret_cast<const float *>(planes[0]);
+            const float *r = reinterpret_cast<const float *>(planes[1]);
+            if (m_kernel == Kernel::Avx2) {
+                done = stereoFloatAvx2(l, r, samples, out);
+            } else if (m_kernel == Kernel::Sse2) {
+                done = stereoFloatSse2(l, r, samples, out);
+            }
+        }
+#endif
+        interleaveScalar<float>(planes, channels, samples, done, out);
+        return true;
+    }
+
+    if (srcFormat == AV_SAMPLE_FMT_S16P) {
+        int16_t *out = reinterpret_cast<int16_t *>(dst);
+        int done = 0;
+#if AUDIO_HAVE_X86
+        if (channels == 2) {
+            const int16_t *l = reinterpret_cast<const int16_t *>(planes[0]);
+            const int16_t *r = reinterpret_cast<const int16_t *>(planes[1]);
+            if (m_kernel == Kernel::Avx2) {
+                done = stereoS16Avx2(l, r, samples, out);
+            } else if (m_kernel == Kernel::Sse2) {
+                done = stereoS16Sse2(l, r, samples, out);
+            }
+        }
+#endif
+        interleaveScalar<int16_t>(planes, channels, samples, done, out);
+        return true;
+    }
+
+    return false;
+}
+
+PlanarInterleaver::Kernel PlanarInterleaver::kernel() const
+{
+    return m_kernel;
+}
@@ -0,0 +1,36 @@
+#ifndef AUDIOCONVERT_H
+#define AUDIOCONVERT_H
+
+extern "C" {
+#include <libavutil/samplefmt.h>
+}
+
+// 平面样本 -> 交错样本（fltp -> flt、s16p -> s16），只改变排列、不改变采样率和声道数
+// 格式与设备一致、仅排列不同时用它代替 swresample；立体声有 SSE2/AVX2 实现，其他声道数走标量
+class PlanarInterleaver
+{
+public:
+    enum class Kernel {
+        Scalar,
+        Sse2,
+        Avx2
+    };
+
+    explicit PlanarInterleaver(Kernel kernel = detectKernel());
+
+    static Kernel detectKernel();
+    static const char *kernelName(Kernel kernel);
+    // src 为 dst 对应的平面格式时返回 true
+    static bool isSupported(AVSampleFormat srcFormat, AVSampleFormat dstFormat);
+
+    // planes 为每个声道的样本，dst 需容纳 samples * channels 个样本
+    bool interleave(const uint8_t *const *planes, int channels, int samples,
+                    AVSampleFormat srcFormat, uint8_t *dst) const;
+
+    Kernel kernel() const;
+
+private:
+    Kernel m_kernel;
+};
+
+#endif // AUDIOCONVERT_H
@@ -0,0 +1,279 @@
+#include "audiooutput.h"
+#include <QDebug>
+#include <cmath>
+#include <cstring>
+
+#define SDL_MAIN_HANDLED
+#include <SDL.h>
+
+AudioOutput::AudioOutput()
+    : m_device(0),
+      m_sampleRate(0),
+      m_channels(0),
+      m_format(SampleFormat::S16),
+      m_bytesPerFrame(0),
+      m_deviceFrames(0),
+      m_silence(0),
+      m_audioInitialized(false),
+      m_writtenBytes(0),
+      m_ptsOrigin(NAN),
+      m_consumedFrames(0),
+      m_callbackNs(0),
+      m_paused(false),
+      m_pausedClock(NAN),
+      m_writerWaiting(false),
+      m_underruns(0),
+      m_overruns(0)
+{
+}
+
+AudioOutput::~AudioOutput()
+{
+    close();
+}
+
+bool AudioOutput::open(int sampleRate, int channels, SampleFormat format, double bufferSeconds)
+{
+    close();
+
+    SDL_SetMainReady();
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0) {
+        m_errorString = QString("SDL 音频子系统初始化失败: %1").arg(SDL_GetError());
+        return false;
+    }
+    m_audioInitialized = true;
+
+    SDL_AudioSpec wanted;
+    SDL_zero(wanted);
+    wanted.freq = sampleRate;
+    wanted.format = format == SampleFormat::F32 ? AUDIO_F32SYS : AUDIO_S16SYS;
+    wanted.channels = static_cast<Uint8>(channels);
+    // 设备缓冲约 20ms，取 2 的幂
+    wanted.samples = 512;
+    while (wanted.samples < sampleRate / 50 && wanted.samples < 8192) {
+        wanted.samples <<= 1;
+    }
+    wanted.callback = &AudioOutput::audioCallback;
+    wanted.userdata = this;
+
+    // 采样率和声道数按设备实际支持的协商，样本格式固定，需要时由 SDL 内部转换
+    SDL_AudioSpec obtained;
+    m_device = SDL_OpenAudioDevice(nullptr, 0, &wanted, &obtained,
+                                   SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_CHANNELS_CHANGE);
+    if (m_device == 0) {
+        m_errorString = QString("无法打开音频设备: %1").arg(SDL_GetError());
+        close();
+        return false;
+    }
+
+    m_sampleRate = obtained.freq;
+    m_channels = obtained.channels;
+    m_format = format;
+    m_bytesPerFrame = m_channels * (format == SampleFormat::F32 ? 4 : 2);
+    m_deviceFrames = obtained.samples;
+    m_silence = obtained.silence;
+
+    m_ring.reset(qMax(static_cast<int>(m_sampleRate * bufferSeconds), m_deviceFrames * 2) * m_bytesPerFrame);
+    m_writtenBytes = 0;
+    m_ptsOrigin = NAN;
+    m_consumedFrames = 0;
+    m_callbackNs = 0;
+    m_paused = false;
+    m_pausedClock = NAN;
+    m_underruns = 0;
+    m_overruns = 0;
+    m_timer.start();
+
+    qDebug() << "音频输出:" << m_sampleRate << "Hz" << m_channels << "声道"
+             << (format == SampleFormat::F32 ? "F32" : "S16") << "设备缓冲" << m_deviceFrames;
+
+    SDL_PauseAudioDevice(m_device, 0);
+    return true;
+}
+
+void AudioOutput::close()
+{
+    if (m_device) {
+        // 关闭后回调不会再被调用
+        SDL_CloseAudioDevice(m_device);
+        m_device = 0;
+    }
+    if (m_audioInitialized) {
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        m_audioInitialized = false;
+    }
+    m_ptsOrigin = NAN;
+    m_consumedFrames = 0;
+}
+
+bool AudioOutput::isOpen() const
+{
+    return m_device != 0;
+}
+
+void AudioOutput::setPaused(bool paused)
+{
+    if (!m_device || paused == m_paused) {
+        return;
+    }
+
+    if (paused) {
+        // 冻结暂停时刻的时钟
+        m_pausedClock = clockAt(m_timer.nsecsElapsed());
+        m_paused = true;
+        SDL_PauseAudioDevice(m_device, 1);
+    } else {
+        m_paused = false;
+        SDL_PauseAudioDevice(m_device, 0);
+    }
+}
+
+void AudioOutput::flush()
+{
+    if (!m_device) {
+        return;
+    }
+
+    SDL_LockAudioDevice(m_device);
+    m_ring.clear();
+    m_writtenBytes = 0;
+    m_ptsOrigin = NAN;
+    m_consumedFrames = 0;
+    m_pausedClock = NAN;
+    SDL_UnlockAudioDevice(m_device);
+    wakeWriter();
+}
+
+int AudioOutput::write(const uint8_t *data, int bytes, double pts)
+{
+    if (!m_device || bytes <= 0) {
+        return 0;
+    }
+
+    // pts 有效时重新推算第 0 帧的时间，时间戳跳变也随之修正
+    if (!std::isnan(pts)) {
+        m_ptsOrigin = pts - static_cast<double>(m_writtenBytes / m_bytesPerFrame) / m_sampleRate;
+    }
+
+    int written = m_ring.write(data, bytes);
+    if (written < bytes) {
+        m_overruns++;
+    }
+    m_writtenBytes += written;
+    return written;
+}
+
+bool AudioOutput::waitWritable(int timeoutMs)
+{
+    if (!m_device) {
+        return false;
+    }
+
+    // 先登记再检查，回调在两者之间取走数据时信号量中已有许可
+    m_writerWaiting = true;
+    if (m_ring.writeAvailable() >= m_bytesPerFrame) {
+        m_writerWaiting = false;
+        return true;
+    }
+    m_spaceAvailable.tryAcquire(1, timeoutMs);
+    m_writerWaiting = false;
+    return m_ring.writeAvailable() >= m_bytesPerFrame;
+}
+
+void AudioOutput::wakeWriter()
+{
+    m_spaceAvailable.release();
+}
+
+double AudioOutput::clock() const
+{
+    if (!m_device) {
+        return NAN;
+    }
+    if (m_paused) {
+        return m_pausedClock;
+    }
+    return clockAt(m_timer.nsecsElapsed());
+}
+
+AudioOutput::Stats AudioOutput::stats() const
+{
+    Stats stats;
+    stats.underruns = m_underruns;
+    stats.overruns = m_overruns;
+    if (m_bytesPerFrame > 0) {
+        stats.bufferedSeconds = static_cast<double>(m_ring.readAvailable()) / m_bytesPerFrame / m_sampleRate;
+        stats.latencySeconds = static_cast<double>(m_deviceFrames) / m_sampleRate;
+    }
+    return stats;
+}
+
+int AudioOutput::sampleRate() const
+{
+    return m_sampleRate;
+}
+
+int AudioOutput::channels() const
+{
+    return m_channels;
+}
+
+AudioOutput::SampleFormat AudioOutput::sampleFormat() const
+{
+    return m_format;
+}
+
+int AudioOutput::bytesPerFrame() const
+{
+    return m_bytesPerFrame;
+}
+
+QString AudioOutput::errorString() const
+{
+    return m_errorString;
+}
+
+void AudioOutput::audioCallback(void *userdata, uint8_t *stream, int len)
+{
+    static_cast<AudioOutput *>(userdata)->fill(stream, len);
+}
+
+// 设备回调线程，不能加锁或分配内存
+void AudioOutput::fill(uint8_t *stream, int len)
+{
+    // 只取完整的样本帧，保证声道不错位
+    int available = qMin(m_ring.readAvailable(), len);
+    int bytes = available - available % m_bytesPerFrame;
+    if (bytes > 0) {
+        m_ring.read(stream, bytes);
+    }
+    if (bytes < len) {
+        memset(stream + bytes, m_silence, len - bytes);
+        if (m_consumedFrames > 0) {
+            m_underruns++;
+        }
+    }
+
+    m_consumedFrames += bytes / m_bytesPerFrame;
+    m_callbackNs = m_timer.nsecsElapsed();
+
+    // 只在写入方登记等待时释放一次，其余回调不触碰信号量
+    if (bytes > 0 && m_writerWaiting.exchange(false)) {
+        m_spaceAvailable.release();
+    }
+}
+
+double AudioOutput::clockAt(qint64 nowNs) const
+{
+    double origin = m_ptsOrigin;
+    qint64 consumed = m_consumedFrames;
+    if (std::isnan(origin) || consumed == 0) {
+        return NAN;
+    }
+
+    // 刚交给设备的一个缓冲区还要等待播放；两次回调之间按经过的时间插值
+    double elapsed = (nowNs - m_callbackNs) / 1e9 * m_sampleRate;
+    elapsed = qBound(0.0, elapsed, static_cast<double>(m_deviceFrames));
+    double played = consumed - m_deviceFrames + elapsed;
+    return origin + qMax(0.0, played) / m_sampleRate;
+}
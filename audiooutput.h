@@ -0,0 +1,90 @@
+#ifndef AUDIOOUTPUT_H
+#define AUDIOOUTPUT_H
+
+#include <QElapsedTimer>
+#include <QSemaphore>
+#include <QString>
+#include <atomic>
+#include "audioringbuffer.h"
+
+// SDL 拉模式音频输出：设备回调从环形缓冲区取样本，解码线程只负责写入
+// 音频时钟 = 已交给设备的样本对应的 pts - 设备缓冲延迟，用作音视频同步的主时钟
+class AudioOutput
+{
+public:
+    enum class SampleFormat {
+        S16,
+        F32
+    };
+
+    struct Stats {
+        qint64 underruns = 0;       // 回调时数据不足，补了静音
+        qint64 overruns = 0;        // 写入时缓冲区已满，写入方需要等待
+        double bufferedSeconds = 0.0;
+        double latencySeconds = 0.0;
+    };
+
+    AudioOutput();
+    ~AudioOutput();
+
+    // bufferSeconds 为环形缓冲区可容纳的时长，打开后立即开始回调（无数据时输出静音）
+    // 设备不支持请求的采样率/声道数时使用设备给出的值，以 sampleRate()/channels() 为准
+    bool open(int sampleRate, int channels, SampleFormat format, double bufferSeconds = 0.5);
+    void close();
+    bool isOpen() const;
+
+    void setPaused(bool paused);
+    // 丢弃尚未播放的数据并重置时钟（跳转后调用）
+    void flush();
+
+    // 写入交错样本，pts 为第一个样本的时间（秒，可为 NAN）；返回实际写入的字节数
+    int write(const uint8_t *data, int bytes, double pts);
+    // 缓冲区满时等待设备回调取走数据，有空间返回 true，超时或被 wakeWriter 唤醒返回 false
+    bool waitWritable(int timeoutMs);
+    void wakeWriter();
+
+    // 当前正在播放的样本时间，尚未开始播放时返回 NAN
+    double clock() const;
+
+    Stats stats() const;
+    int sampleRate() const;
+    int channels() const;
+    SampleFormat sampleFormat() const;
+    int bytesPerFrame() const;
+    QString errorString() const;
+
+private:
+    static void audioCallback(void *userdata, uint8_t *stream, int len);
+    void fill(uint8_t *stream, int len);
+    double clockAt(qint64 nowNs) const;
+
+    quint32 m_device;
+    int m_sampleRate;
+    int m_channels;
+    SampleFormat m_format;
+    int m_bytesPerFrame;
+    int m_deviceFrames;
+    uint8_t m_silence;
+    bool m_audioInitialized;
+    QString m_errorString;
+
+    AudioRingBuffer m_ring;
+
+    // 写入方维护：已写入的字节数，以及“第 0 帧对应的 pts”
+    qint64 m_writtenBytes;
+    std::atomic<double> m_ptsOrigin;
+    // 回调维护：已交给设备的样本帧数和回调时刻
+    std::atomic<qint64> m_consumedFrames;
+    std::atomic<qint64> m_callbackNs;
+    std::atomic<bool> m_paused;
+    std::atomic<double> m_pausedClock;
+    QElapsedTimer m_timer;
+    // 写入方等待空间时由回调释放一次
+    std::atomic<bool> m_writerWaiting;
+    QSemaphore m_spaceAvailable;
+
+    std::atomic<qint64> m_underruns;
+    std::atomic<qint64> m_overruns;
+};
+
+#endif // AUDIOOUTPUT_H
@@ -0,0 +1,83 @@
+#include "audioringbuffer.h"
+#include <cstring>
+
+AudioRingBuffer::AudioRingBuffer()
+    : m_mask(0),
+      m_writePos(0),
+      m_readPos(0)
+{
+}
+
+void AudioRingBuffer::reset(int capacity)
+{
+    quint64 size = 1;
+    while (size < static_cast<quint64>(qMax(capacity, 1))) {
+        size <<= 1;
+    }
+
+    m_buffer.assign(size, 0);
+    m_mask = size - 1;
+    m_writePos.store(0, std::memory_order_relaxed);
+    m_readPos.store(0, std::memory_order_relaxed);
+}
+
+void AudioRingBuffer::clear()
+{
+    m_readPos.store(m_writePos.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+int AudioRingBuffer::write(const uint8_t *data, int bytes)
+{
+    quint64 writePos = m_writePos.load(std::memory_order_relaxed);
+    quint64 readPos = m_readPos.load(std::memory_order_acquire);
+    quint64 space = m_buffer.size() - (writePos - readPos);
+    int count = static_cast<int>(qMin<quint64>(space, static_cast<quint64>(bytes)));
+    if (count <= 0) {
+        return 0;
+    }
+
+    // 跨越缓冲区末尾时分两段拷贝
+    quint64 offset = writePos & m_mask;
+    int first = static_cast<int>(qMin<quint64>(count, m_buffer.size() - offset));
+    memcpy(m_buffer.data() + offset, data, first);
+    memcpy(m_buffer.data(), data + first, count - first);
+
+    m_writePos.store(writePos + count, std::memory_order_release);
+    return count;
+}
+
+int AudioRingBuffer::read(uint8_t *data, int bytes)
+{
+    quint64 readPos = m_readPos.load(std::memory_order_relaxed);
+    quint64 writePos = m_writePos.load(std::memory_order_acquire);
+    int count = static_cast<int>(qMin<quint64>(writePos - readPos, static_cast<quint64>(bytes)));
+    if (count <= 0) {
+        return 0;
+    }
+
+    quint64 offset = readPos & m_mask;
+    int first = static_cast<int>(qMin<quint64>(count, m_buffer.size() - offset));
+    memcpy(data, m_buffer.data() + offset, first);
+    memcpy(data + first, m_buffer.data(), count - first);
+
+    m_readPos.store(readPos + count, std::memory_order_release);
+    return count;
+}
+
+int AudioRingBuffer::readAvailable() const
+{
+    // 先读 readPos：writePos 只增不减，差值不会为负
+    quint64 readPos = m_readPos.load(std::memory_order_acquire);
+    quint64 writePos = m_writePos.load(std::memory_order_acquire);
+    return static_cast<int>(writePos - readPos);
+}
+
+int AudioRingBuffer::writeAvailable() const
+{
+    return capacity() - readAvailable();
+}
+
+int AudioRingBuffer::capacity() const
+{
+    return static_cast<int>(m_buffer.size());
+}
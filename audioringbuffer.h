@@ -0,0 +1,37 @@
+#ifndef AUDIORINGBUFFER_H
+#define AUDIORINGBUFFER_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <vector>
+
+// 单生产者/单消费者无锁环形缓冲区（按字节）
+// 写入方（音频解码线程）和读取方（音频设备回调）各自只移动自己的位置，互不加锁
+class AudioRingBuffer
+{
+public:
+    AudioRingBuffer();
+
+    // 容量向上取整为 2 的幂；只能在两端都停止时调用
+    void reset(int capacity);
+    // 丢弃未读数据；只能在读取方停止（如锁住音频设备）时调用
+    void clear();
+
+    // 返回实际写入/读出的字节数，空间或数据不足时只处理一部分
+    int write(const uint8_t *data, int bytes);
+    int read(uint8_t *data, int bytes);
+
+    int readAvailable() const;
+    int writeAvailable() const;
+    int capacity() const;
+
+private:
+    std::vector<uint8_t> m_buffer;
+    quint64 m_mask;
+
+    // 分开放在不同缓存行，避免两端互相失效
+    alignas(64) std::atomic<quint64> m_writePos;
+    alignas(64) std::atomic<quint64> m_readPos;
+};
+
+#endif // AUDIORINGBUFFER_H
@@ -17,19 +17,63 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    audioconvert.cpp \
+    audiooutput.cpp \
+    audioringbuffer.cpp \
     ffmpegprocessor.cpp \
     fileuploader.cpp \
+    framemailbox.cpp \
+    framepool.cpp \
+    glvideowidget.cpp \
+    keyframeindex.cpp \
     main.cpp \
     mainwindow.cpp \
+    mediaclock.cpp \
+    packetqueue.cpp \
+    probecache.cpp \
+    rastervideowidget.cpp \
+    sdlvideosink.cpp \
+    sdlvideowidget.cpp \
+    seekcoordinator.cpp \
+    seekindexer.cpp \
+    seekindexfile.cpp \
+    streamscheduler.cpp \
+    swscache.cpp \
+    thumbnailservice.cpp \
     tmyvideowidget.cpp \
-    videoplayer.cpp
+    videoframe.cpp \
+    videoplayer.cpp \
+    videowallwidget.cpp \
+    yuvconvert.cpp
 
 HEADERS += \
+    audioconvert.h \
+    audiooutput.h \
+    audioringbuffer.h \
     ffmpegprocessor.h \
     fileuploader.h \
+    framemailbox.h \
+    framepool.h \
+    glvideowidget.h \
+    keyframeindex.h \
     mainwindow.h \
+    mediaclock.h \
+    packetqueue.h \
+    probecache.h \
+    rastervideowidget.h \
+    sdlvideosink.h \
+    sdlvideowidget.h \
+    seekcoordinator.h \
+    seekindexer.h \
+    seekindexfile.h \
+    streamscheduler.h \
+    swscache.h \
+    thumbnailservice.h \
     tmyvideowidget.h \
-    videoplayer.h
+    videoframe.h \
+    videoplayer.h \
+    videowallwidget.h \
+    yuvconvert.h
 
 FORMS += \
     mainwindow.ui
@@ -1,6 +1,19 @@
 ﻿#include "ffmpegprocessor.h"
 #include <QDebug>
 #include <QDateTime>
+#include <QFileInfo>
+#include <cmath>
+
+// 同时在外的输出帧上限：解码端一帧 + 排队/显示中的若干帧
+static const int kFramePoolCapacity = 8;
+// 帧时间戳与主时钟相差超过该值视为时间戳跳变，重新对齐时钟而不是等待或丢帧
+static const double kMaxFrameDelay = 10.0;
+// 音频缓冲区满时等待设备回调的上限（毫秒），正常情况下一个设备周期内就被唤醒
+static const int kAudioWriteWait = 100;
+// 协作模式下等待音频设备消费的时间（微秒）
+static const qint64 kCooperativeIdleWait = 20000;
+// 协作模式下音频设备缓冲超过该时长（秒）就不再解码音频
+static const double kCooperativeAudioAhead = 0.3;
 
 FFmpegProcessor::FFmpegProcessor(QObject *parent)
     : QObject(parent),
@@ -10,14 +23,76 @@ FFmpegProcessor::FFmpegProcessor(QObject *parent)
       m_frameRGB(nullptr),
       m_packet(nullptr),
       m_swsContext(nullptr),
+      m_useYuvConverter(false),
+      m_outputFormat(AV_PIX_FMT_NONE),
+      m_requestedOutputFormat(OutputFormat::RGB32),
+      m_devicePixelRatio(1.0),
+      m_outputWidth(0),
+      m_outputHeight(0),
       m_status(StreamStatus::Stopped),
       m_videoStreamIndex(-1),
-      m_rgbBuffer(nullptr),
       m_videoWidth(0),
       m_videoHeight(0),
-      m_frameRate(0.0)
+      m_decodedWidth(0),
+      m_decodedHeight(0),
+      m_frameRate(0.0),
+      m_decodeProfile(DecodeProfile::Auto),
+      m_decodeThreadCount(0),
+      m_openProfile(OpenProfile::Auto),
+      m_lowLatency(false),
+      m_firstFramePresented(false),
+      m_interrupted(false),
+      m_ioDeadline(0),
+      m_openTimeout(5000),
+      m_readTimeout(5000),
+      m_probeCacheEnabled(true),
+      m_probeVerified(true),
+      m_probeMismatch(false),
+      m_audioStreamIndex(-1),
+      m_audioCodecContext(nullptr),
+      m_swrContext(nullptr),
+      m_audioFrame(nullptr),
+      m_audioBuffer(nullptr),
+      m_audioBufferSize(0),
+      m_audioSampleRate(0),
+      m_audioChannels(0),
+      m_audioSampleFormat(AV_SAMPLE_FMT_NONE),
+      m_audioChannelLayout(0),
+      m_audioOutSampleRate(0),
+      m_audioOutChannels(0),
+      m_audioOutSampleFormat(AV_SAMPLE_FMT_NONE),
+      m_audioPath(AudioPath::Resample),
+      m_audioResampleQuality(AudioResampleQuality::Balanced),
+      m_videoPacketQueue(16 * 1024 * 1024, 2.0),
+      m_audioPacketQueue(1024 * 1024, 2.0),
+      m_videoDecodeThread(nullptr),
+      m_audioDecodeThread(nullptr),
+      m_demuxEof(false),
+      m_cooperative(false),
+      m_audioDecoding(false),
+      m_decodePacket(nullptr),
+      m_audioDecodePacket(nullptr),
+      m_heldFrame(false),
+      m_minFrameInterval(0.0),
+      m_lastPresentedPts(NAN),
+      m_skipNonReference(false),
+      m_lowres(0),
+      m_codecMaxLowres(0),
+      m_audioEnabled(true),
+      m_seekIndexer(nullptr),
+      m_seekMode(SeekMode::Accurate),
+      m_videoSeekTarget(NAN),
+      m_audioSeekTarget(NAN),
+      m_seekPending(false),
+      m_seekSkippedFrames(0),
+      m_seekUsedIndex(false)
 {
+    qRegisterMetaType<VideoFrame>("VideoFrame");
+    m_ioTimer.start();
+    m_streamInfo = std::make_shared<const StreamInfo>();
     initFFmpeg();
+    qDebug() << "YUV->RGB kernel:" << YuvToRgbConverter::kernelName(m_yuvConverter.kernel());
+    qDebug() << "Audio interleave kernel:" << PlanarInterleaver::kernelName(m_interleaver.kernel());
 }
 
 FFmpegProcessor::~FFmpegProcessor()
@@ -41,15 +116,25 @@ bool FFmpegProcessor::openStream(const QString &url)
     QMutexLocker locker(&m_mutex);
 
     if (m_status == StreamStatus::Playing || m_status == StreamStatus::Connecting) {
-        m_errorString = "Stream is already open";
+        setErrorString("Stream is already open");
         return false;
     }
 
-    m_status = StreamStatus::Connecting;
-    emit statusChanged(static_cast<int>(m_status));
+    setStatus(StreamStatus::Connecting);
 
     // 清理之前的资源
     cleanup();
+    m_url = url;
+
+    m_lowLatency = m_openProfile == OpenProfile::LowLatency
+            || (m_openProfile == OpenProfile::Auto && isLiveUrl());
+    m_latencyTimer.start();
+    m_firstFramePresented = false;
+    {
+        QMutexLocker syncLocker(&m_syncMutex);
+        m_latencyStats = LatencyStats();
+        m_latencyStats.lowLatency = m_lowLatency;
+    }
 
     // 打开视频流
     QByteArray urlBytes = url.toUtf8();
@@ -58,47 +143,83 @@ bool FFmpegProcessor::openStream(const QString &url)
     AVDictionary *options = nullptr;
     av_dict_set(&options, "rtsp_transport", "tcp", 0);
     av_dict_set(&options, "stimeout", "5000000", 0);
+    applyOpenProfile(&options);
+
+    // 中断回调在打开之前设置，连接和探测阶段同样可以被取消
+    m_formatContext = avformat_alloc_context();
+    m_formatContext->interrupt_callback.callback = &FFmpegProcessor::interruptCallback;
+    m_formatContext->interrupt_callback.opaque = this;
+    armIoDeadline(m_openTimeout);
 
     int ret = avformat_open_input(&m_formatContext, cUrl, nullptr, &options);
     av_dict_free(&options);
+    double connectTime = m_latencyTimer.nsecsElapsed() / 1e6;
 
+    // 被 interrupt 取消不算错误
+    if (ret != 0 && m_interrupted) {
+        setStatus(StreamStatus::Stopped);
+        return false;
+    }
     if (ret != 0) {
-        m_errorString = QString("无法打开视频流: %1").arg(ret);
-        emit errorOccurred(m_errorString);
-        m_status = StreamStatus::Error;
-        emit statusChanged(static_cast<int>(m_status));
+        reportError(QString("无法打开视频流: %1").arg(ret));
+        setStatus(StreamStatus::Error);
         return false;
     }
 
     // 获取流信息
-    if (avformat_find_stream_info(m_formatContext, nullptr) < 0) {
-        m_errorString = "无法获取流信息";
-        emit errorOccurred(m_errorString);
-        m_status = StreamStatus::Error;
-        emit statusChanged(static_cast<int>(m_status));
+    if (!probeStreams()) {
+        if (m_interrupted) {
+            setStatus(StreamStatus::Stopped);
+            return false;
+        }
+        reportError("无法获取流信息");
+        setStatus(StreamStatus::Error);
         return false;
     }
+    double probeTime = m_latencyTimer.nsecsElapsed() / 1e6 - connectTime;
+    {
+        QMutexLocker syncLocker(&m_syncMutex);
+        m_latencyStats.connectTime = connectTime;
+        m_latencyStats.probeTime = probeTime;
+        m_latencyStats.probeFromCache = !m_probeEntry.isNull();
+    }
+    qDebug() << "打开流:" << (m_lowLatency ? "low-latency" : "standard")
+             << "连接" << connectTime << "ms 探测" << probeTime << "ms" << (m_probeEntry ? "(缓存)" : "");
 
     // 查找视频流
     m_videoStreamIndex = -1;
-    for (unsigned int i = 0; i < m_formatContext->nb_streams; i++) {
-        if (m_formatContext->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
-            m_videoStreamIndex = i;
-            break;
+    if (m_probeEntry) {
+        m_videoStreamIndex = m_probeEntry->videoStreamIndex;
+    } else {
+        for (unsigned int i = 0; i < m_formatContext->nb_streams; i++) {
+            if (m_formatContext->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
+                m_videoStreamIndex = i;
+                break;
+            }
         }
     }
 
     if (m_videoStreamIndex == -1) {
-        m_errorString = "未找到视频流";
-        emit errorOccurred(m_errorString);
-        m_status = StreamStatus::Error;
-        emit statusChanged(static_cast<int>(m_status));
+        reportError("未找到视频流");
+        setStatus(StreamStatus::Error);
         return false;
     }
 
+    // 本地文件的关键帧索引
+    openSeekIndex();
+
     // 在成功打开视频流后，初始化音频
-    if (m_videoStreamIndex != -1) {
-        if (!initAudio()) {
+    if (!m_audioEnabled) {
+        // 只记录音频流序号（探测缓存需要），解复用时直接丢弃
+        m_audioStreamIndex = m_probeEntry ? m_probeEntry->audioStreamIndex
+                                          : av_find_best_stream(m_formatContext, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+        if (m_audioStreamIndex >= 0) {
+            m_formatContext->streams[m_audioStreamIndex]->discard = AVDISCARD_ALL;
+        } else {
+            m_audioStreamIndex = -1;
+        }
+    } else if (m_videoStreamIndex != -1) {
+        if (!openAudioDecoder()) {
             qDebug() << "音频初始化失败，继续播放视频";
         } else {
             qDebug() << "音频初始化成功";
@@ -116,8 +237,23 @@ bool FFmpegProcessor::openStream(const QString &url)
         return false;
     }
 
-    m_status = StreamStatus::Playing;
-    emit statusChanged(static_cast<int>(m_status));
+    // 完整探测的结果留给下次打开
+    if (m_probeCacheEnabled && !m_probeEntry) {
+        ProbeCache::instance().store(url, m_formatContext, m_videoStreamIndex, m_audioStreamIndex);
+    }
+
+    publishStreamInfo();
+    setStatus(StreamStatus::Playing);
+
+    m_clock.reset();
+    m_clock.setPaused(false);
+    {
+        QMutexLocker syncLocker(&m_syncMutex);
+        m_syncStats = SyncStats();
+    }
+
+    // 启动解码线程，readFrame 之后只负责解复用
+    startDecodeThreads();
     return true;
 }
 
@@ -131,8 +267,7 @@ void FFmpegProcessor::closeStream()
 
     cleanup();
 
-    m_status = StreamStatus::Stopped;
-    emit statusChanged(static_cast<int>(m_status));
+    setStatus(StreamStatus::Stopped);
 }
 
 bool FFmpegProcessor::readFrame()
@@ -141,32 +276,53 @@ bool FFmpegProcessor::readFrame()
         return false;
     }
 
+    // 缓存的探测结果与码流不符：丢弃缓存，完整探测后重新打开
+    // 协作模式下解码在其他线程进行，由调度器暂停该流后在打开线程池中重新打开
+    if (m_probeMismatch && m_cooperative) {
+        return false;
+    }
+    if (m_probeMismatch) {
+        return reopen();
+    }
+
     if (!m_packet) {
         m_packet = av_packet_alloc();
     }
 
+    armIoDeadline(m_readTimeout);
     int ret = av_read_frame(m_formatContext, m_packet);
     if (ret < 0) {
         if (ret == AVERROR_EOF) {
-            qDebug() << "End of stream";
-        } else {
-            m_errorString = QString("读取帧失败: %1").arg(ret);
-            emit errorOccurred(m_errorString);
+            if (!m_demuxEof) {
+                qDebug() << "End of stream";
+                // 送入空包让解码线程冲刷缓存的帧
+                m_demuxEof = true;
+                m_videoPacketQueue.putNullPacket(m_videoStreamIndex);
+                if (m_audioDecoding) {
+                    m_audioPacketQueue.putNullPacket(m_audioStreamIndex);
+                }
+            }
+        } else if (!m_interrupted) {
+            reportError(QString("读取帧失败: %1").arg(ret));
         }
         return false;
     }
 
+    m_demuxEof = false;
+
+    // 出现缓存中没有的流
+    if (!m_probeVerified && m_packet->stream_index >= m_probeEntry->streams.size()) {
+        m_probeMismatch = true;
+    }
+
+    // 按流分发到各自的队列，队列满时在此阻塞
     if (m_packet->stream_index == m_videoStreamIndex) {
-        if (!decodePacket(m_packet)) {
-            av_packet_unref(m_packet);
-            return false;
-        }
+        m_keyframeIndex.addPacket(m_packet->pts != AV_NOPTS_VALUE ? m_packet->pts : m_packet->dts,
+                                  m_packet->pos, m_packet->flags & AV_PKT_FLAG_KEY);
+        return m_videoPacketQueue.put(m_packet);
     }
-    else if (m_packet->stream_index == m_audioStreamIndex) {
-        if (!decodeAudioPacket(m_packet)) {
-            av_packet_unref(m_packet);
-            return false;
-        }
+    else if (m_packet->stream_index == m_audioStreamIndex && m_audioDecoding) {
+        return m_audioPacketQueue.put(m_packet);
     }
 
     av_packet_unref(m_packet);
@@ -179,7 +335,7 @@ QImage FFmpegProcessor::getCurrentFrame()
         return QImage();
     }
 
-    return avFrameToQImage(m_frameRGB);
+    return VideoFrame(m_frameRGB).toImage();
 }
 
 FFmpegProcessor::StreamStatus FFmpegProcessor::getStatus() const
@@ -187,66 +343,351 @@ FFmpegProcessor::StreamStatus FFmpegProcessor::getStatus() const
     return m_status;
 }
 
+bool FFmpegProcessor::isEndOfStream() const
+{
+    return m_demuxEof;
+}
+
 QString FFmpegProcessor::getErrorString() const
 {
-    return m_errorString;
+    std::shared_ptr<const QString> error = std::atomic_load(&m_errorString);
+    return error ? *error : QString();
+}
+
+FFmpegProcessor::StreamInfo FFmpegProcessor::getStreamInfo() const
+{
+    return *std::atomic_load(&m_streamInfo);
 }
 
 int FFmpegProcessor::getVideoWidth() const
 {
-    return m_videoWidth;
+    return std::atomic_load(&m_streamInfo)->videoWidth;
 }
 
 int FFmpegProcessor::getVideoHeight() const
 {
-    return m_videoHeight;
+    return std::atomic_load(&m_streamInfo)->videoHeight;
 }
 
 double FFmpegProcessor::getFrameRate() const
 {
-    return m_frameRate;
+    return std::atomic_load(&m_streamInfo)->frameRate;
 }
 
 QString FFmpegProcessor::getCodecName() const
 {
-    return m_codecName;
+    return std::atomic_load(&m_streamInfo)->codecName;
+}
+
+void FFmpegProcessor::setStatus(StreamStatus status)
+{
+    m_status = status;
+    {
+        // 暂停中的解码线程随状态变化立即返回
+        QMutexLocker locker(&m_decodeGateMutex);
+        m_decodeGate.wakeAll();
+    }
+    emit statusChanged(static_cast<int>(status));
+}
+
+void FFmpegProcessor::setErrorString(const QString &message)
+{
+    std::atomic_store(&m_errorString, std::make_shared<const QString>(message));
+}
+
+void FFmpegProcessor::reportError(const QString &message)
+{
+    setErrorString(message);
+    emit errorOccurred(message);
+}
+
+// 由当前的流信息成员生成新快照整体替换，读取方拿到的旧快照在最后一个引用释放时析构
+// 打开和关闭流时整体重建快照，此时解码线程没有运行
+void FFmpegProcessor::publishStreamInfo()
+{
+    QMutexLocker locker(&m_infoMutex);
+    std::shared_ptr<StreamInfo> info = std::make_shared<StreamInfo>();
+    info->url = m_url;
+    info->videoStreamIndex = m_videoStreamIndex;
+    info->videoWidth = m_videoWidth;
+    info->videoHeight = m_videoHeight;
+    info->decodedWidth = m_decodedWidth;
+    info->decodedHeight = m_decodedHeight;
+    info->frameRate = m_frameRate;
+    info->codecName = m_codecName;
+    info->audioStreamIndex = m_audioStreamIndex;
+    info->audioSampleRate = m_audioSampleRate;
+    info->audioChannels = m_audioChannels;
+    info->audioCodecName = m_audioCodecName;
+    if (m_formatContext && m_formatContext->duration != AV_NOPTS_VALUE) {
+        info->duration = m_formatContext->duration / static_cast<double>(AV_TIME_BASE);
+    }
+    std::atomic_store(&m_streamInfo, std::shared_ptr<const StreamInfo>(info));
+}
+
+// 解码线程只修改自己负责的字段：在当前快照的副本上修改后替换，写入方之间用 m_infoMutex 串行，
+// 视频和音频同时变化时不会互相覆盖
+void FFmpegProcessor::updateStreamInfo(const std::function<void(StreamInfo &)> &update)
+{
+    QMutexLocker locker(&m_infoMutex);
+    std::shared_ptr<StreamInfo> info = std::make_shared<StreamInfo>(*std::atomic_load(&m_streamInfo));
+    update(*info);
+    std::atomic_store(&m_streamInfo, std::shared_ptr<const StreamInfo>(info));
+}
+
+void FFmpegProcessor::setDecodeProfile(DecodeProfile profile)
+{
+    QMutexLocker locker(&m_mutex);
+    m_decodeProfile = profile;
+}
+
+FFmpegProcessor::DecodeProfile FFmpegProcessor::getDecodeProfile() const
+{
+    return m_decodeProfile;
+}
+
+void FFmpegProcessor::setOpenProfile(OpenProfile profile)
+{
+    QMutexLocker locker(&m_mutex);
+    m_openProfile = profile;
+}
+
+FFmpegProcessor::OpenProfile FFmpegProcessor::getOpenProfile() const
+{
+    return m_openProfile;
+}
+
+void FFmpegProcessor::setAudioEnabled(bool enabled)
+{
+    QMutexLocker locker(&m_mutex);
+    m_audioEnabled = enabled;
+}
+
+bool FFmpegProcessor::isAudioEnabled() const
+{
+    return m_audioEnabled;
+}
+
+void FFmpegProcessor::setLowres(int level)
+{
+    m_lowres = qBound(0, level, 3);
+}
+
+int FFmpegProcessor::getLowres() const
+{
+    return m_lowres;
+}
+
+FFmpegProcessor::LatencyStats FFmpegProcessor::getLatencyStats() const
+{
+    LatencyStats stats;
+    {
+        QMutexLocker locker(&m_syncMutex);
+        stats = m_latencyStats;
+    }
+    stats.demuxBuffer = m_videoPacketQueue.stats().duration * 1000.0;
+    FrameMailbox::Stats mailboxStats = m_frameMailbox.stats();
+    stats.displayDelay = mailboxStats.avgDelay;
+    stats.displayDroppedFrames = mailboxStats.coalesced;
+    stats.audioOutputDelay = m_audioOutput.stats().latencySeconds * 1000.0;
+
+    // 有音频时视频跟随音频播放位置，设备缓冲也计入画面延迟
+    stats.estimatedLatency = stats.demuxBuffer + stats.decodeTime + stats.decoderDelay
+            + stats.scheduleDelay + stats.displayDelay;
+    if (m_clock.isAudioMaster()) {
+        stats.estimatedLatency += stats.audioOutputDelay;
+    }
+    return stats;
+}
+
+void FFmpegProcessor::setDecodeThreadCount(int count)
+{
+    QMutexLocker locker(&m_mutex);
+    m_decodeThreadCount = qMax(0, count);
+}
+
+int FFmpegProcessor::getDecodeThreadCount() const
+{
+    return m_decodeThreadCount;
 }
 
 void FFmpegProcessor::pause()
 {
     if (m_status == StreamStatus::Playing) {
-        m_status = StreamStatus::Paused;
-        emit statusChanged(static_cast<int>(m_status));
+        m_clock.setPaused(true);
+        m_audioOutput.setPaused(true);
+        setStatus(StreamStatus::Paused);
+        // 等待缓冲区空间的音频解码线程转去等待恢复
+        m_audioOutput.wakeWriter();
     }
 }
 
 void FFmpegProcessor::resume()
 {
     if (m_status == StreamStatus::Paused) {
-        m_status = StreamStatus::Playing;
-        emit statusChanged(static_cast<int>(m_status));
+        m_audioOutput.setPaused(false);
+        m_clock.setPaused(false);
+        setStatus(StreamStatus::Playing);
     }
 }
 
 void FFmpegProcessor::seek(double seconds)
 {
-    if (m_formatContext && m_videoStreamIndex >= 0) {
-        int64_t timestamp = seconds * AV_TIME_BASE;
-        av_seek_frame(m_formatContext, -1, timestamp, AVSEEK_FLAG_BACKWARD);
+    if (!m_formatContext || m_videoStreamIndex < 0) {
+        return;
+    }
+
+    m_seekTimer.start();
+    armIoDeadline(m_readTimeout);
+
+    // 解码线程停下后才能冲刷解码器，队列中跳转前的包一并丢弃
+    stopDecodeThreads();
+
+    AVStream *stream = m_formatContext->streams[m_videoStreamIndex];
+    int64_t target = av_rescale_q(llrint(seconds * AV_TIME_BASE), AV_TIME_BASE_Q, stream->time_base);
+
+    // 后台索引完成后映射旁路文件
+    if (!m_seekIndexFile.isOpen() && m_seekIndexer && m_seekIndexer->isFinished()) {
+        if (m_seekIndexFile.open(m_url) && m_seekIndexFile.streamIndex() != m_videoStreamIndex) {
+            m_seekIndexFile.close();
+        }
+    }
+
+    // 索引中有目标所在的 GOP 时直接定位到该关键帧
+    int ret = -1;
+    KeyframeIndex::Entry entry;
+    SeekIndexFile::Entry fileEntry;
+    bool found = false;
+    if (m_seekIndexFile.isOpen() && m_seekIndexFile.lookup(target, &fileEntry)) {
+        entry.pts = fileEntry.pts;
+        entry.pos = fileEntry.pos;
+        found = true;
+    } else {
+        found = m_keyframeIndex.lookup(target, &entry);
+    }
+
+    m_seekUsedIndex = false;
+    if (found) {
+        if (!(m_formatContext->iformat->flags & AVFMT_NO_BYTE_SEEK)) {
+            ret = av_seek_frame(m_formatContext, m_videoStreamIndex, entry.pos, AVSEEK_FLAG_BYTE);
+        } else {
+            ret = avformat_seek_file(m_formatContext, m_videoStreamIndex, entry.pts, entry.pts, entry.pts, 0);
+        }
+        m_seekUsedIndex = ret >= 0;
+    }
+    if (ret < 0) {
+        ret = av_seek_frame(m_formatContext, m_videoStreamIndex, target, AVSEEK_FLAG_BACKWARD);
+    }
+    if (ret < 0) {
+        reportError(QString("跳转失败: %1").arg(ret));
+    }
+    m_keyframeIndex.breakRun();
+
+    if (m_codecContext) {
+        avcodec_flush_buffers(m_codecContext);
+    }
+    if (m_audioCodecContext) {
+        avcodec_flush_buffers(m_audioCodecContext);
+    }
+    if (m_swrContext) {
+        // 丢弃重采样器内部缓存的样本
+        swr_init(m_swrContext);
+    }
+    m_audioOutput.flush();
+
+    // 跳转后由第一帧重新对齐时钟
+    m_clock.reset();
+
+    bool accurate = m_seekMode == SeekMode::Accurate && ret >= 0;
+    m_videoSeekTarget = accurate ? seconds : NAN;
+    m_audioSeekTarget = accurate ? seconds : NAN;
+    m_seekSkippedFrames = 0;
+    m_seekPending = true;
+
+    startDecodeThreads();
+}
+
+void FFmpegProcessor::setSeekMode(SeekMode mode)
+{
+    QMutexLocker locker(&m_mutex);
+    m_seekMode = mode;
+}
+
+FFmpegProcessor::SeekMode FFmpegProcessor::getSeekMode() const
+{
+    return m_seekMode;
+}
+
+FFmpegProcessor::SeekStats FFmpegProcessor::getSeekStats() const
+{
+    QMutexLocker locker(&m_syncMutex);
+    return m_seekStats;
+}
+
+// 视频解码线程：跳转后第一帧发出时记录延迟
+void FFmpegProcessor::finishSeek(double pts)
+{
+    m_seekPending = false;
+    double latency = m_seekTimer.nsecsElapsed() / 1e6;
+    {
+        QMutexLocker locker(&m_syncMutex);
+        m_seekStats.seeks++;
+        m_seekStats.lastLatency = latency;
+        m_seekStats.lastSkippedFrames = m_seekSkippedFrames;
+        m_seekStats.lastUsedIndex = m_seekUsedIndex;
+    }
+    qDebug() << "跳转完成:" << pts << "延迟" << latency << "ms 跳过" << m_seekSkippedFrames
+             << "帧" << (m_seekUsedIndex ? "(索引)" : "");
+    emit seekFinished(pts, latency);
+}
+
+// 为没有自带索引的本地文件（ts、flv 等）映射或建立旁路索引
+void FFmpegProcessor::openSeekIndex()
+{
+    if (!QFileInfo(m_url).isFile()) {
+        return;
+    }
+
+    // mp4/mkv 等容器自带索引，av_seek_frame 本身就很快
+    AVStream *stream = m_formatContext->streams[m_videoStreamIndex];
+    if (stream->nb_index_entries > 0 && !(m_formatContext->iformat->flags & AVFMT_GENERIC_INDEX)) {
+        return;
+    }
+
+    if (m_seekIndexFile.open(m_url) && m_seekIndexFile.streamIndex() == m_videoStreamIndex) {
+        qDebug() << "已加载关键帧索引:" << m_seekIndexFile.size() << "个关键帧";
+        return;
     }
+    m_seekIndexFile.close();
+
+    m_seekIndexer = new SeekIndexer(m_url);
+    connect(m_seekIndexer, &SeekIndexer::progressChanged, this, &FFmpegProcessor::seekIndexProgress);
+    connect(m_seekIndexer, &SeekIndexer::indexFailed, [](const QString &error) {
+        qDebug() << error;
+    });
+    m_seekIndexer->start(QThread::LowestPriority);
 }
 
 // 初始化音频相关资源
 bool FFmpegProcessor::initAudio()
 {
     QMutexLocker locker(&m_mutex);
+    return openAudioDecoder();
+}
 
+// 调用方已持有 m_mutex（openStream 中调用）
+bool FFmpegProcessor::openAudioDecoder()
+{
     // 查找音频流
     m_audioStreamIndex = -1;
-    for (unsigned int i = 0; i < m_formatContext->nb_streams; i++) {
-        if (m_formatContext->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO) {
-            m_audioStreamIndex = i;
-            break;
+    if (m_probeEntry) {
+        m_audioStreamIndex = m_probeEntry->audioStreamIndex;
+    } else {
+        for (unsigned int i = 0; i < m_formatContext->nb_streams; i++) {
+            if (m_formatContext->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO) {
+                m_audioStreamIndex = i;
+                break;
+            }
         }
     }
 
@@ -260,23 +701,23 @@ bool FFmpegProcessor::initAudio()
     const AVCodec *codec = avcodec_find_decoder(codecParameters->codec_id);
 
     if (!codec) {
-        m_errorString = "不支持的音频解码器";
+        setErrorString("不支持的音频解码器");
         return false;
     }
 
     m_audioCodecContext = avcodec_alloc_context3(codec);
     if (!m_audioCodecContext) {
-        m_errorString = "无法分配音频解码器上下文";
+        setErrorString("无法分配音频解码器上下文");
         return false;
     }
 
     if (avcodec_parameters_to_context(m_audioCodecContext, codecParameters) < 0) {
-        m_errorString = "无法复制音频编解码器参数";
+        setErrorString("无法复制音频编解码器参数");
         return false;
     }
 
     if (avcodec_open2(m_audioCodecContext, codec, nullptr) < 0) {
-        m_errorString = "无法打开音频解码器";
+        setErrorString("无法打开音频解码器");
         return false;
     }
 
@@ -284,20 +725,54 @@ bool FFmpegProcessor::initAudio()
     m_audioSampleRate = m_audioCodecContext->sample_rate;
     m_audioChannels = m_audioCodecContext->channels;
     m_audioSampleFormat = m_audioCodecContext->sample_fmt;
+    m_audioChannelLayout = m_audioCodecContext->channel_layout;
     m_audioCodecName = QString(codec->name);
 
-    // 初始化音频重采样上下文
-    if (!initSwrContext()) {
-        return false;
-    }
-
     // 初始化音频帧
     m_audioFrame = av_frame_alloc();
     if (!m_audioFrame) {
-        m_errorString = "无法分配音频帧内存";
+        setErrorString("无法分配音频帧内存");
+        return false;
+    }
+
+    // 按源格式请求设备，设备不支持时由 SDL 给出最接近的采样率和声道数
+    AVSampleFormat packedFormat = av_get_packed_sample_fmt(m_audioSampleFormat);
+    AudioOutput::SampleFormat deviceFormat = packedFormat == AV_SAMPLE_FMT_S16 || packedFormat == AV_SAMPLE_FMT_U8
+            ? AudioOutput::SampleFormat::S16 : AudioOutput::SampleFormat::F32;
+    if (m_audioOutput.open(m_audioSampleRate, qBound(1, m_audioChannels, 8), deviceFormat)) {
+        m_audioOutSampleRate = m_audioOutput.sampleRate();
+        m_audioOutChannels = m_audioOutput.channels();
+        m_audioOutSampleFormat = deviceFormat == AudioOutput::SampleFormat::F32 ? AV_SAMPLE_FMT_FLT : AV_SAMPLE_FMT_S16;
+        // 以音频播放位置为主时钟
+        m_clock.setAudioClockSource([this] { return m_audioOutput.clock(); });
+    } else {
+        qDebug() << m_audioOutput.errorString();
+        // 没有音频设备时经 audioReady 输出 44100Hz 16 位立体声
+        m_audioOutSampleRate = 44100;
+        m_audioOutChannels = 2;
+        m_audioOutSampleFormat = AV_SAMPLE_FMT_S16;
+    }
+
+    // 采样率和声道数一致时不经过 swresample
+    m_audioPath = AudioPath::Resample;
+    if (m_audioOutSampleRate == m_audioSampleRate && m_audioOutChannels == m_audioChannels) {
+        if (m_audioSampleFormat == m_audioOutSampleFormat) {
+            m_audioPath = AudioPath::Passthrough;
+        } else if (PlanarInterleaver::isSupported(m_audioSampleFormat, m_audioOutSampleFormat)) {
+            m_audioPath = AudioPath::Interleave;
+        }
+    }
+
+    if (m_audioPath == AudioPath::Resample && !initSwrContext()) {
+        m_audioOutput.close();
+        m_clock.setAudioClockSource(MediaClock::AudioClockSource());
         return false;
     }
 
+    qDebug() << "音频输出路径:" << audioPathName(m_audioPath)
+             << m_audioSampleRate << "Hz" << m_audioChannels << av_get_sample_fmt_name(m_audioSampleFormat)
+             << "->" << m_audioOutSampleRate << "Hz" << m_audioOutChannels << av_get_sample_fmt_name(m_audioOutSampleFormat);
+
     return true;
 }
 
@@ -306,51 +781,126 @@ bool FFmpegProcessor::decodeAudioPacket(AVPacket *packet)
 {
     int ret = avcodec_send_packet(m_audioCodecContext, packet);
     if (ret < 0) {
-        m_errorString = QString("发送音频数据包到解码器失败: %1").arg(ret);
-        emit errorOccurred(m_errorString);
+        reportError(QString("发送音频数据包到解码器失败: %1").arg(ret));
         return false;
     }
 
+    int bytesPerFrame = m_audioOutChannels * av_get_bytes_per_sample(m_audioOutSampleFormat);
+
     while (ret >= 0) {
         ret = avcodec_receive_frame(m_audioCodecContext, m_audioFrame);
         if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
             return true;
         } else if (ret < 0) {
-            m_errorString = QString("接收解码音频帧失败: %1").arg(ret);
-            emit errorOccurred(m_errorString);
+            reportError(QString("接收解码音频帧失败: %1").arg(ret));
             return false;
         }
 
-        // 重采样音频
-        int out_samples = av_rescale_rnd(swr_get_delay(m_swrContext, m_audioFrame->sample_rate) +
-                                        m_audioFrame->nb_samples, 44100, m_audioFrame->sample_rate, AV_ROUND_UP);
-
-        int buffer_size = av_samples_get_buffer_size(nullptr, 2, out_samples, AV_SAMPLE_FMT_S16, 1);
-        if (buffer_size < 0) {
-            m_errorString = "无法计算音频缓冲区大小";
-            emit errorOccurred(m_errorString);
-            return false;
+        double pts = NAN;
+        if (m_audioFrame->best_effort_timestamp != AV_NOPTS_VALUE) {
+            pts = m_audioFrame->best_effort_timestamp * av_q2d(m_formatContext->streams[m_audioStreamIndex]->time_base);
         }
 
-        if (!m_audioBuffer || m_audioBufferSize < buffer_size) {
-            av_free(m_audioBuffer);
-            m_audioBuffer = (uint8_t *)av_malloc(buffer_size);
-            m_audioBufferSize = buffer_size;
+        // 精确跳转：整帧都在目标之前的音频直接丢弃
+        if (!std::isnan(m_audioSeekTarget)) {
+            if (!std::isnan(pts) && m_audioFrame->sample_rate > 0
+                    && pts + static_cast<double>(m_audioFrame->nb_samples) / m_audioFrame->sample_rate <= m_audioSeekTarget) {
+                av_frame_unref(m_audioFrame);
+                continue;
+            }
+            m_audioSeekTarget = NAN;
         }
 
-        uint8_t *out_data[1] = { m_audioBuffer };
-        int samples = swr_convert(m_swrContext, out_data, out_samples,
-                                (const uint8_t **)m_audioFrame->data, m_audioFrame->nb_samples);
+        // 流中途改变格式时（如广播流切换节目）：直通路径改为重采样，已在重采样的按新的输入格式重建
+        // m_audioSampleFormat/Rate/Channels 始终是当前输出路径所对应的输入格式
+        bool layoutChanged = m_audioFrame->channel_layout && m_audioChannelLayout
+                && m_audioFrame->channel_layout != static_cast<uint64_t>(m_audioChannelLayout);
+        if (m_audioFrame->format != m_audioSampleFormat || m_audioFrame->sample_rate != m_audioSampleRate
+                || m_audioFrame->channels != m_audioChannels || layoutChanged) {
+            qDebug() << "音频格式变化，按新格式重建重采样:" << m_audioFrame->sample_rate << "Hz"
+                     << m_audioFrame->channels << av_get_sample_fmt_name(static_cast<AVSampleFormat>(m_audioFrame->format));
+            m_audioSampleFormat = static_cast<AVSampleFormat>(m_audioFrame->format);
+            m_audioSampleRate = m_audioFrame->sample_rate;
+            m_audioChannels = m_audioFrame->channels;
+            m_audioChannelLayout = m_audioFrame->channel_layout;
+            m_audioPath = AudioPath::Resample;
+            int sampleRate = m_audioSampleRate;
+            int channels = m_audioChannels;
+            updateStreamInfo([sampleRate, channels](StreamInfo &info) {
+                info.audioSampleRate = sampleRate;
+                info.audioChannels = channels;
+            });
+            if (!initSwrContext()) {
+                // 重建失败后不能再用旧的上下文转换新格式的帧
+                swr_free(&m_swrContext);
+                emit errorOccurred(getErrorString());
+                av_frame_unref(m_audioFrame);
+                return false;
+            }
+        }
 
-        if (samples < 0) {
-            m_errorString = "音频重采样失败";
-            emit errorOccurred(m_errorString);
-            return false;
+        const uint8_t *data = nullptr;
+        int samples = 0;
+
+        if (m_audioPath == AudioPath::Passthrough) {
+            data = m_audioFrame->extended_data[0];
+            samples = m_audioFrame->nb_samples;
+        } else if (m_audioPath == AudioPath::Interleave) {
+            if (!reserveAudioBuffer(m_audioFrame->nb_samples * bytesPerFrame)) {
+                return false;
+            }
+            m_interleaver.interleave(m_audioFrame->extended_data, m_audioChannels, m_audioFrame->nb_samples,
+                                     m_audioSampleFormat, m_audioBuffer);
+            data = m_audioBuffer;
+            samples = m_audioFrame->nb_samples;
+        } else if (!m_swrContext) {
+            // 格式变化后重建失败，丢弃到下一次格式变化
+            av_frame_unref(m_audioFrame);
+            continue;
+        } else {
+            // 重采样器内部缓存的样本先输出，起始时间要往前推
+            if (!std::isnan(pts)) {
+                pts -= static_cast<double>(swr_get_delay(m_swrContext, m_audioOutSampleRate)) / m_audioOutSampleRate;
+            }
+
+            int out_samples = av_rescale_rnd(swr_get_delay(m_swrContext, m_audioFrame->sample_rate) +
+                                            m_audioFrame->nb_samples, m_audioOutSampleRate, m_audioFrame->sample_rate, AV_ROUND_UP);
+            if (!reserveAudioBuffer(out_samples * bytesPerFrame)) {
+                return false;
+            }
+
+            uint8_t *out_data[1] = { m_audioBuffer };
+            samples = swr_convert(m_swrContext, out_data, out_samples,
+                                  (const uint8_t **)m_audioFrame->extended_data, m_audioFrame->nb_samples);
+            if (samples < 0) {
+                reportError("音频重采样失败");
+                return false;
+            }
+            data = m_audioBuffer;
         }
 
-        // 发送音频数据信号
-        QByteArray audioData((const char *)m_audioBuffer, samples * 2 * 2); // 16位立体声
-        emit audioReady(audioData);
+        if (m_audioOutput.isOpen()) {
+            // 写入环形缓冲区，满时等待设备回调消费
+            int remaining = samples * bytesPerFrame;
+            while (remaining > 0 && !m_audioPacketQueue.isAborted()) {
+                int written = m_audioOutput.write(data, remaining, pts);
+                data += written;
+                remaining -= written;
+                pts = NAN;
+                if (remaining > 0) {
+                    // 暂停时设备不再回调，改为等待恢复
+                    if (m_status == StreamStatus::Paused) {
+                        waitDecodeGate(m_audioPacketQueue, 0);
+                    } else {
+                        m_audioOutput.waitWritable(kAudioWriteWait);
+                    }
+                }
+            }
+        } else {
+            // 发送音频数据信号
+            QByteArray audioData((const char *)data, samples * bytesPerFrame);
+            emit audioReady(audioData);
+        }
 
         av_frame_unref(m_audioFrame);
     }
@@ -358,185 +908,1067 @@ bool FFmpegProcessor::decodeAudioPacket(AVPacket *packet)
     return true;
 }
 
+bool FFmpegProcessor::reserveAudioBuffer(int size)
+{
+    if (size <= 0) {
+        reportError("无法计算音频缓冲区大小");
+        return false;
+    }
+
+    if (!m_audioBuffer || m_audioBufferSize < size) {
+        av_free(m_audioBuffer);
+        m_audioBuffer = (uint8_t *)av_malloc(size);
+        m_audioBufferSize = m_audioBuffer ? size : 0;
+        if (!m_audioBuffer) {
+            reportError("无法分配音频缓冲区");
+            return false;
+        }
+    }
+    return true;
+}
+
+const char *FFmpegProcessor::audioPathName(AudioPath path)
+{
+    switch (path) {
+    case AudioPath::Passthrough:
+        return "passthrough";
+    case AudioPath::Interleave:
+        return "interleave";
+    default:
+        return "swresample";
+    }
+}
+
+void FFmpegProcessor::setAudioResampleQuality(AudioResampleQuality quality)
+{
+    QMutexLocker locker(&m_mutex);
+    m_audioResampleQuality = quality;
+}
+
+FFmpegProcessor::AudioResampleQuality FFmpegProcessor::getAudioResampleQuality() const
+{
+    return m_audioResampleQuality;
+}
+
 // 音频信息获取函数
 int FFmpegProcessor::getAudioStreamIndex() const
 {
-    return m_audioStreamIndex;
+    return std::atomic_load(&m_streamInfo)->audioStreamIndex;
 }
 
 int FFmpegProcessor::getAudioSampleRate() const
 {
-    return m_audioSampleRate;
+    return std::atomic_load(&m_streamInfo)->audioSampleRate;
 }
 
 int FFmpegProcessor::getAudioChannels() const
 {
-    return m_audioChannels;
+    return std::atomic_load(&m_streamInfo)->audioChannels;
 }
 
 QString FFmpegProcessor::getAudioCodecName() const
 {
-    return m_audioCodecName;
+    return std::atomic_load(&m_streamInfo)->audioCodecName;
 }
 
-bool FFmpegProcessor::initCodec()
+PacketQueue::Stats FFmpegProcessor::getVideoQueueStats() const
 {
-    AVCodecParameters *codecParameters = m_formatContext->streams[m_videoStreamIndex]->codecpar;
-    const AVCodec *codec = avcodec_find_decoder(codecParameters->codec_id);
-
-    if (!codec) {
-        m_errorString = "不支持的解码器";
-        emit errorOccurred(m_errorString);
-        return false;
-    }
+    return m_videoPacketQueue.stats();
+}
 
-    m_codecContext = avcodec_alloc_context3(codec);
-    if (!m_codecContext) {
-        m_errorString = "无法分配解码器上下文";
-        emit errorOccurred(m_errorString);
-        return false;
-    }
+PacketQueue::Stats FFmpegProcessor::getAudioQueueStats() const
+{
+    return m_audioPacketQueue.stats();
+}
 
-    if (avcodec_parameters_to_context(m_codecContext, codecParameters) < 0) {
-        m_errorString = "无法复制编解码器参数";
-        emit errorOccurred(m_errorString);
-        return false;
-    }
+FFmpegProcessor::SyncStats FFmpegProcessor::getSyncStats() const
+{
+    QMutexLocker locker(&m_syncMutex);
+    SyncStats stats = m_syncStats;
+    stats.audioMaster = m_clock.isAudioMaster();
+    return stats;
+}
 
-    if (avcodec_open2(m_codecContext, codec, nullptr) < 0) {
-        m_errorString = "无法打开解码器";
-        emit errorOccurred(m_errorString);
-        return false;
-    }
+AudioOutput::Stats FFmpegProcessor::getAudioOutputStats() const
+{
+    return m_audioOutput.stats();
+}
 
-    // 保存视频信息
-    m_videoWidth = m_codecContext->width;
-    m_videoHeight = m_codecContext->height;
-    m_codecName = QString(codec->name);
+void FFmpegProcessor::setPacketQueueLimits(qint64 maxBytes, double maxDuration)
+{
+    m_videoPacketQueue.setLimits(maxBytes, maxDuration);
+    // 音频包小，字节上限按比例缩小，时长上限保持一致
+    m_audioPacketQueue.setLimits(qMax<qint64>(maxBytes / 16, 64 * 1024), maxDuration);
+}
 
-    // 计算帧率
-    AVStream *stream = m_formatContext->streams[m_videoStreamIndex];
-    if (stream->avg_frame_rate.den != 0) {
-        m_frameRate = av_q2d(stream->avg_frame_rate);
-    } else if (stream->r_frame_rate.den != 0) {
-        m_frameRate = av_q2d(stream->r_frame_rate);
-    } else {
-        m_frameRate = 25.0; // 默认值
+void FFmpegProcessor::startDecodeThreads()
+{
+    m_demuxEof = false;
+    m_lastPresentedPts = NAN;
+
+    // 协作模式只启动队列，解码由 step 推进
+    m_videoPacketQueue.setTimeBase(m_formatContext->streams[m_videoStreamIndex]->time_base);
+    m_videoPacketQueue.start();
+    if (!m_cooperative) {
+        m_videoDecodeThread = QThread::create([this] { videoDecodeLoop(); });
+        m_videoDecodeThread->start();
     }
 
-    return true;
+    m_audioDecoding = m_audioCodecContext && m_audioFrame && (m_swrContext || m_audioPath != AudioPath::Resample);
+    if (m_audioDecoding) {
+        m_audioPacketQueue.setTimeBase(m_formatContext->streams[m_audioStreamIndex]->time_base);
+        m_audioPacketQueue.start();
+        if (!m_cooperative) {
+            m_audioDecodeThread = QThread::create([this] { audioDecodeLoop(); });
+            m_audioDecodeThread->start();
+        }
+    }
 }
 
-bool FFmpegProcessor::initSwsContext()
+void FFmpegProcessor::stopDecodeThreads()
 {
-    m_frame = av_frame_alloc();
-    m_frameRGB = av_frame_alloc();
+    m_videoPacketQueue.abort();
+    m_audioPacketQueue.abort();
+    {
+        QMutexLocker locker(&m_decodeGateMutex);
+        m_decodeGate.wakeAll();
+    }
+    m_audioOutput.wakeWriter();
 
-    if (!m_frame || !m_frameRGB) {
-        m_errorString = "无法分配帧内存";
-        emit errorOccurred(m_errorString);
-        return false;
+    if (m_videoDecodeThread) {
+        m_videoDecodeThread->wait();
+        delete m_videoDecodeThread;
+        m_videoDecodeThread = nullptr;
     }
 
-    m_swsContext = sws_getContext(
-        m_videoWidth, m_videoHeight, m_codecContext->pix_fmt,
-        m_videoWidth, m_videoHeight, AV_PIX_FMT_RGB24,
-        SWS_BILINEAR, nullptr, nullptr, nullptr);
+    if (m_audioDecodeThread) {
+        m_audioDecodeThread->wait();
+        delete m_audioDecodeThread;
+        m_audioDecodeThread = nullptr;
+    }
 
-    if (!m_swsContext) {
-        m_errorString = "无法创建图像转换上下文";
-        emit errorOccurred(m_errorString);
-        return false;
+    if (m_heldFrame) {
+        av_frame_unref(m_frame);
+        m_heldFrame = false;
     }
+    m_audioDecoding = false;
 
-    int numBytes = av_image_get_buffer_size(AV_PIX_FMT_RGB24, m_videoWidth, m_videoHeight, 1);
-    m_rgbBuffer = (uint8_t *)av_malloc(numBytes * sizeof(uint8_t));
+    m_videoPacketQueue.flush();
+    m_audioPacketQueue.flush();
+}
 
-    av_image_fill_arrays(m_frameRGB->data, m_frameRGB->linesize, m_rgbBuffer,
-                        AV_PIX_FMT_RGB24, m_videoWidth, m_videoHeight, 1);
+void FFmpegProcessor::setCooperative(bool cooperative)
+{
+    QMutexLocker locker(&m_mutex);
+    m_cooperative = cooperative;
+}
 
-    return true;
+bool FFmpegProcessor::isCooperative() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cooperative;
 }
 
-bool FFmpegProcessor::decodePacket(AVPacket *packet)
+void FFmpegProcessor::setFrameRateLimit(double fps)
 {
-    int ret = avcodec_send_packet(m_codecContext, packet);
-    if (ret < 0) {
-        m_errorString = QString("发送数据包到解码器失败: %1").arg(ret);
-        emit errorOccurred(m_errorString);
-        return false;
-    }
+    m_minFrameInterval = fps > 0.0 ? 1.0 / fps : 0.0;
+}
 
-    while (ret >= 0) {
-        ret = avcodec_receive_frame(m_codecContext, m_frame);
+double FFmpegProcessor::getFrameRateLimit() const
+{
+    double interval = m_minFrameInterval;
+    return interval > 0.0 ? 1.0 / interval : 0.0;
+}
+
+void FFmpegProcessor::setSkipNonReference(bool skip)
+{
+    m_skipNonReference = skip;
+}
+
+// lowres 级别变化时在关键帧处重建解码器，之后的帧不再参考之前的帧
+bool FFmpegProcessor::applyLowres(const AVPacket *packet)
+{
+    int lowres = qMin<int>(m_lowres, m_codecMaxLowres);
+    if (lowres == m_codecContext->lowres || !packet->data || !(packet->flags & AV_PKT_FLAG_KEY)) {
+        return true;
+    }
+
+    avcodec_free_context(&m_codecContext);
+    if (!initCodec()) {
+        setStatus(StreamStatus::Error);
+        return false;
+    }
+    qDebug() << "解码分辨率级别切换为" << m_codecContext->lowres;
+    return true;
+}
+
+// 在解码线程中应用，避免与 avcodec_send_packet 并发修改
+void FFmpegProcessor::applySkipFrame()
+{
+    AVDiscard discard = m_skipNonReference ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+    if (m_codecContext->skip_frame != discard) {
+        m_codecContext->skip_frame = discard;
+    }
+}
+
+// 协作模式下读取线程据此决定是否读取：未到流末尾且队列未满，readFrame 不会阻塞在队列上
+bool FFmpegProcessor::canDemux() const
+{
+    return m_status == StreamStatus::Playing && !m_demuxEof && !m_probeMismatch
+            && !m_videoPacketQueue.isFull() && !(m_audioDecoding && m_audioPacketQueue.isFull());
+}
+
+// 正在播放且队列中有待解码的包，工作线程据此决定挂起还是继续调度
+bool FFmpegProcessor::hasDecodableData() const
+{
+    if (m_status != StreamStatus::Playing) {
+        return false;
+    }
+    return m_videoPacketQueue.stats().packets > 0 || (m_audioDecoding && m_audioPacketQueue.stats().packets > 0);
+}
+
+bool FFmpegProcessor::needsReopen() const
+{
+    return m_probeMismatch;
+}
+
+// 缓存的探测结果与码流不符时丢弃缓存，完整探测后重新打开；协作模式下由调度器在该流停止解码后调用
+bool FFmpegProcessor::reopen()
+{
+    qDebug() << "探测缓存与码流不符，重新探测:" << m_url;
+    ProbeCache::instance().remove(m_url);
+    QString url = m_url;
+    closeStream();
+    return openStream(url);
+}
+
+// 协作模式的一个时间片：解码视频和音频，各自最多处理 packetBudget 个包/帧
+// 解复用由调度器的读取线程完成，这里只消费队列中已有的数据包，不做任何阻塞 I/O
+qint64 FFmpegProcessor::step(int packetBudget)
+{
+    // 暂停时挂起，恢复由调度器的控制操作重新排队
+    if (m_status != StreamStatus::Playing) {
+        return -1;
+    }
+
+    // 返回值合并：-1 表示没有要求，0 表示立即继续，否则取最早的等待时间
+    auto merge = [](qint64 a, qint64 b) {
+        if (a < 0) return b;
+        if (b < 0) return a;
+        return qMin(a, b);
+    };
+
+    // 两个队列都空时返回 -1，读取线程放入新的数据包后再唤醒
+    qint64 wait = videoStep(packetBudget);
+    if (m_audioDecoding) {
+        wait = merge(wait, audioStep(packetBudget));
+    }
+    return wait;
+}
+
+// 返回 0 表示还有可解码的数据，正数为持有的帧距显示时间的微秒数，-1 表示队列已空
+qint64 FFmpegProcessor::videoStep(int packetBudget)
+{
+    if (!m_decodePacket) {
+        m_decodePacket = av_packet_alloc();
+    }
+
+    for (int i = 0; i < packetBudget; i++) {
+        if (!m_heldFrame) {
+            int ret = avcodec_receive_frame(m_codecContext, m_frame);
+            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+                // 解码器需要更多数据
+                if (m_videoPacketQueue.get(m_decodePacket, false) <= 0) {
+                    return -1;
+                }
+                if (!applyLowres(m_decodePacket)) {
+                    av_packet_unref(m_decodePacket);
+                    return -1;
+                }
+                applySkipFrame();
+                ret = avcodec_send_packet(m_codecContext, m_decodePacket);
+                av_packet_unref(m_decodePacket);
+                if (ret < 0) {
+                    if (!m_probeVerified) {
+                        m_probeMismatch = true;
+                    }
+                    reportError(QString("发送数据包到解码器失败: %1").arg(ret));
+                }
+                continue;
+            } else if (ret < 0) {
+                reportError(QString("接收解码帧失败: %1").arg(ret));
+                continue;
+            }
+
+            if (!m_probeVerified) {
+                verifyProbeFrame(m_frame);
+            }
+            {
+                QMutexLocker locker(&m_syncMutex);
+                double frameDuration = m_frameRate > 0.0 ? 1000.0 / m_frameRate : 40.0;
+                m_latencyStats.decoderDelay = m_codecContext->has_b_frames * frameDuration;
+            }
+            m_heldFrame = true;
+        }
+
+        // 未到显示时间的帧留在 m_frame 中，下个时间片再处理
+        double pts = framePts(m_frame);
+        double earlyBy = 0.0;
+        FrameAction action = prepareFrame(pts, false, &earlyBy);
+        if (action == FrameAction::Hold) {
+            return qBound<qint64>(1000, static_cast<qint64>(earlyBy * 1e6), kCooperativeIdleWait);
+        }
+        if (action == FrameAction::Present) {
+            presentFrame(pts);
+        }
+        av_frame_unref(m_frame);
+        m_heldFrame = false;
+    }
+
+    return 0;
+}
+
+// 设备缓冲足够时不再解码，避免写入时阻塞工作线程
+qint64 FFmpegProcessor::audioStep(int packetBudget)
+{
+    if (!m_audioDecodePacket) {
+        m_audioDecodePacket = av_packet_alloc();
+    }
+
+    for (int i = 0; i < packetBudget; i++) {
+        if (m_audioOutput.isOpen() && m_audioOutput.stats().bufferedSeconds > kCooperativeAudioAhead) {
+            return kCooperativeIdleWait;
+        }
+        if (m_audioPacketQueue.get(m_audioDecodePacket, false) <= 0) {
+            return -1;
+        }
+        decodeAudioPacket(m_audioDecodePacket);
+        av_packet_unref(m_audioDecodePacket);
+    }
+
+    return 0;
+}
+
+// 视频解码线程：取包、解码、转换并发出帧
+void FFmpegProcessor::videoDecodeLoop()
+{
+    AVPacket *packet = av_packet_alloc();
+
+    while (!m_videoPacketQueue.isAborted()) {
+        if (m_status == StreamStatus::Paused) {
+            waitDecodeGate(m_videoPacketQueue, 0);
+            continue;
+        }
+
+        if (m_videoPacketQueue.get(packet, true) < 0) {
+            break;
+        }
+
+        decodePacket(packet);
+        av_packet_unref(packet);
+    }
+
+    av_packet_free(&packet);
+}
+
+// 暂停时一直等到状态变化或队列中止，否则最多等待 timeoutMs
+void FFmpegProcessor::waitDecodeGate(const PacketQueue &queue, unsigned long timeoutMs)
+{
+    QMutexLocker locker(&m_decodeGateMutex);
+    if (queue.isAborted()) {
+        return;
+    }
+    if (m_status == StreamStatus::Paused) {
+        m_decodeGate.wait(&m_decodeGateMutex);
+    } else if (timeoutMs > 0) {
+        m_decodeGate.wait(&m_decodeGateMutex, timeoutMs);
+    }
+}
+
+// 音频解码线程：取包、解码并重采样
+void FFmpegProcessor::audioDecodeLoop()
+{
+    AVPacket *packet = av_packet_alloc();
+
+    while (!m_audioPacketQueue.isAborted()) {
+        if (m_status == StreamStatus::Paused) {
+            waitDecodeGate(m_audioPacketQueue, 0);
+            continue;
+        }
+
+        if (m_audioPacketQueue.get(packet, true) < 0) {
+            break;
+        }
+
+        decodeAudioPacket(packet);
+        av_packet_unref(packet);
+    }
+
+    av_packet_free(&packet);
+}
+
+bool FFmpegProcessor::initCodec()
+{
+    AVCodecParameters *codecParameters = m_formatContext->streams[m_videoStreamIndex]->codecpar;
+    const AVCodec *codec = avcodec_find_decoder(codecParameters->codec_id);
+
+    if (!codec) {
+        reportError("不支持的解码器");
+        return false;
+    }
+
+    m_codecContext = avcodec_alloc_context3(codec);
+    if (!m_codecContext) {
+        reportError("无法分配解码器上下文");
+        return false;
+    }
+
+    if (avcodec_parameters_to_context(m_codecContext, codecParameters) < 0) {
+        reportError("无法复制编解码器参数");
+        return false;
+    }
+
+    // 按播放场景配置解码线程
+    applyDecodeProfile(codec);
+    // 解码阶段降分辨率，只有部分解码器支持（H.264/HEVC 不支持）
+    m_codecMaxLowres = codec->max_lowres;
+    m_codecContext->lowres = qMin<int>(m_lowres, m_codecMaxLowres);
+
+    if (avcodec_open2(m_codecContext, codec, nullptr) < 0) {
+        reportError("无法打开解码器");
+        return false;
+    }
+
+    // 保存视频信息，lowres 时解码器尺寸已缩小，取码流的原始尺寸
+    m_videoWidth = codecParameters->width > 0 ? codecParameters->width : m_codecContext->width;
+    m_videoHeight = codecParameters->height > 0 ? codecParameters->height : m_codecContext->height;
+    m_codecName = QString(codec->name);
+
+    // 计算帧率
+    AVStream *stream = m_formatContext->streams[m_videoStreamIndex];
+    if (stream->avg_frame_rate.den != 0) {
+        m_frameRate = av_q2d(stream->avg_frame_rate);
+    } else if (stream->r_frame_rate.den != 0) {
+        m_frameRate = av_q2d(stream->r_frame_rate);
+    } else {
+        m_frameRate = 25.0; // 默认值
+    }
+
+    return true;
+}
+
+FFmpegProcessor::DecodeProfile FFmpegProcessor::resolveDecodeProfile() const
+{
+    // 低延迟打开方式总是配合低延迟解码
+    if (m_lowLatency) {
+        return DecodeProfile::Live;
+    }
+    if (m_decodeProfile != DecodeProfile::Auto) {
+        return m_decodeProfile;
+    }
+
+    // 实时流走低延迟配置，本地文件和 HLS 点播走高吞吐配置
+    return isLiveUrl() ? DecodeProfile::Live : DecodeProfile::File;
+}
+
+// 同时唤醒阻塞在满队列上的写入方，解复用线程不必等解码线程取走数据包
+void FFmpegProcessor::interrupt()
+{
+    m_interrupted = true;
+    m_videoPacketQueue.interrupt();
+    m_audioPacketQueue.interrupt();
+}
+
+void FFmpegProcessor::clearInterrupt()
+{
+    m_interrupted = false;
+    m_videoPacketQueue.clearInterrupt();
+    m_audioPacketQueue.clearInterrupt();
+}
+
+bool FFmpegProcessor::isInterrupted() const
+{
+    return m_interrupted;
+}
+
+void FFmpegProcessor::setIoTimeouts(int openTimeoutMs, int readTimeoutMs)
+{
+    QMutexLocker locker(&m_mutex);
+    m_openTimeout = qMax(0, openTimeoutMs);
+    m_readTimeout = qMax(0, readTimeoutMs);
+}
+
+// FFmpeg 在阻塞的网络调用中周期性（约 100ms）调用，返回非 0 时该调用以 AVERROR_EXIT 失败
+int FFmpegProcessor::interruptCallback(void *opaque)
+{
+    FFmpegProcessor *processor = static_cast<FFmpegProcessor *>(opaque);
+    if (processor->m_interrupted) {
+        return 1;
+    }
+    qint64 deadline = processor->m_ioDeadline;
+    return deadline > 0 && processor->m_ioTimer.nsecsElapsed() > deadline;
+}
+
+void FFmpegProcessor::armIoDeadline(int timeoutMs)
+{
+    m_ioDeadline = timeoutMs > 0 ? m_ioTimer.nsecsElapsed() + qint64(timeoutMs) * 1000000 : 0;
+}
+
+void FFmpegProcessor::setProbeCacheEnabled(bool enabled)
+{
+    QMutexLocker locker(&m_mutex);
+    m_probeCacheEnabled = enabled;
+}
+
+bool FFmpegProcessor::isProbeCacheEnabled() const
+{
+    return m_probeCacheEnabled;
+}
+
+// 获取流信息：同一 URL 有缓存且流布局一致时直接写回编码参数，否则完整探测
+bool FFmpegProcessor::probeStreams()
+{
+    m_probeMismatch = false;
+    m_probeEntry.clear();
+    if (m_probeCacheEnabled) {
+        m_probeEntry = ProbeCache::instance().find(m_url);
+        if (m_probeEntry && !ProbeCache::apply(*m_probeEntry, m_formatContext)) {
+            m_probeEntry.clear();
+        }
+    }
+    m_probeVerified = !m_probeEntry;
+    if (m_probeEntry) {
+        return true;
+    }
+    return avformat_find_stream_info(m_formatContext, nullptr) >= 0;
+}
+
+// 第一帧与缓存的编码参数核对，分辨率或像素格式不同说明码流已经变化
+void FFmpegProcessor::verifyProbeFrame(const AVFrame *frame)
+{
+    // lowres 时帧尺寸按级别缩小，缓存的尺寸换算后再比较
+    const AVCodecParameters *cached = m_probeEntry->streams.at(m_videoStreamIndex).codecpar;
+    int lowres = m_codecContext->lowres;
+    bool matches = (cached->width == 0 || AV_CEIL_RSHIFT(cached->width, lowres) == frame->width)
+            && (cached->height == 0 || AV_CEIL_RSHIFT(cached->height, lowres) == frame->height)
+            && (cached->format < 0 || cached->format == frame->format);
+    if (matches) {
+        m_probeVerified = true;
+    } else {
+        m_probeMismatch = true;
+    }
+}
+
+bool FFmpegProcessor::isLiveUrl() const
+{
+    QString url = m_url.toLower();
+    return url.startsWith("rtsp://") || url.startsWith("rtmp://") || url.startsWith("rtp://")
+            || url.startsWith("udp://") || url.startsWith("srt://");
+}
+
+// 低延迟打开：探测只读少量数据，关闭解复用缓冲和重排序等待
+void FFmpegProcessor::applyOpenProfile(AVDictionary **options)
+{
+    if (!m_lowLatency) {
+        return;
+    }
+
+    av_dict_set(options, "fflags", "nobuffer", 0);
+    // 探测上限 32KB / 0.2 秒，RTSP 的编码参数通常已在 SDP 中给出
+    av_dict_set(options, "probesize", "32768", 0);
+    av_dict_set(options, "analyzeduration", "200000", 0);
+    // TCP 传输不会乱序，不需要重排序缓冲
+    av_dict_set(options, "max_delay", "0", 0);
+    av_dict_set(options, "reorder_queue_size", "0", 0);
+}
+
+void FFmpegProcessor::applyDecodeProfile(const AVCodec *codec)
+{
+    // 协作模式下并行来自调度器同时解码的多路流，每路默认单线程
+    int threads = m_decodeThreadCount > 0 ? m_decodeThreadCount : (m_cooperative ? 1 : QThread::idealThreadCount());
+    // 解码器内部对帧线程数有上限，超过后只增加内存和延迟
+    threads = qBound(1, threads, 16);
+
+    if (resolveDecodeProfile() == DecodeProfile::Live) {
+        // 帧线程每个线程会引入一帧延迟，实时流只使用切片线程
+        m_codecContext->flags |= AV_CODEC_FLAG_LOW_DELAY;
+        if (codec->capabilities & AV_CODEC_CAP_SLICE_THREADS) {
+            m_codecContext->thread_type = FF_THREAD_SLICE;
+            m_codecContext->thread_count = threads;
+        } else {
+            m_codecContext->thread_type = 0;
+            m_codecContext->thread_count = 1;
+        }
+    } else {
+        m_codecContext->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+        m_codecContext->thread_count = threads;
+    }
+
+    qDebug() << "解码线程配置:" << (resolveDecodeProfile() == DecodeProfile::Live ? "live" : "file")
+             << "threads" << m_codecContext->thread_count;
+}
+
+bool FFmpegProcessor::initSwsContext()
+{
+    m_frame = av_frame_alloc();
+    m_frameRGB = av_frame_alloc();
+
+    if (!m_frame || !m_frameRGB) {
+        reportError("无法分配帧内存");
+        return false;
+    }
+
+    // 转换上下文按帧的实际尺寸和格式在 convertFrameToRGB 中从缓存获取
+    m_swsCache.clear();
+    m_swsContext = nullptr;
+    return true;
+}
+
+// 按当前帧的尺寸/格式和显示尺寸选择转换上下文，必要时重建缓冲池
+bool FFmpegProcessor::updateSwsContext(const AVFrame *frame)
+{
+    AVPixelFormat srcFormat = static_cast<AVPixelFormat>(frame->format);
+    if (frame->width <= 0 || frame->height <= 0 || srcFormat == AV_PIX_FMT_NONE) {
+        return false;
+    }
+
+    // lowres 时帧尺寸是编码尺寸按级别缩小后的值，只有与之不符才是 HLS 切换码率或 SPS 变化
+    if (frame->width != m_decodedWidth || frame->height != m_decodedHeight) {
+        int lowres = m_codecContext->lowres;
+        const AVCodecParameters *codecParameters = m_formatContext->streams[m_videoStreamIndex]->codecpar;
+        int width = m_videoWidth;
+        int height = m_videoHeight;
+        if (frame->width == AV_CEIL_RSHIFT(codecParameters->width, lowres)
+                && frame->height == AV_CEIL_RSHIFT(codecParameters->height, lowres)) {
+            width = codecParameters->width;
+            height = codecParameters->height;
+        } else if (frame->width != AV_CEIL_RSHIFT(m_videoWidth, lowres)
+                   || frame->height != AV_CEIL_RSHIFT(m_videoHeight, lowres)) {
+            // 码流参数未更新，由帧尺寸换算回编码尺寸
+            width = frame->width << lowres;
+            height = frame->height << lowres;
+        }
+        if (width != m_videoWidth || height != m_videoHeight) {
+            qDebug() << "视频分辨率变化:" << m_videoWidth << "x" << m_videoHeight
+                     << "->" << width << "x" << height;
+        }
+
+        m_videoWidth = width;
+        m_videoHeight = height;
+        m_decodedWidth = frame->width;
+        m_decodedHeight = frame->height;
+        int decodedWidth = m_decodedWidth;
+        int decodedHeight = m_decodedHeight;
+        updateStreamInfo([width, height, decodedWidth, decodedHeight](StreamInfo &info) {
+            info.videoWidth = width;
+            info.videoHeight = height;
+            info.decodedWidth = decodedWidth;
+            info.decodedHeight = decodedHeight;
+        });
+    }
+
+    QSize target = targetOutputSize(QSize(frame->width, frame->height));
+    AVPixelFormat outputFormat;
+    {
+        QMutexLocker locker(&m_outputMutex);
+        outputFormat = pixelFormat(m_requestedOutputFormat);
+    }
+    bool formatChanged = outputFormat != m_outputFormat;
+    m_outputFormat = outputFormat;
+
+    // 原尺寸输出且格式受支持时走手写内核，其余情况缩放直接在 sws_scale 中完成
+    m_useYuvConverter = target.width() == frame->width && target.height() == frame->height
+            && YuvToRgbConverter::isSupported(srcFormat, m_outputFormat);
+    if (!m_useYuvConverter) {
+        // 色彩矩阵和范围与手写内核的选择一致，画面跨过原尺寸切换转换方式时颜色不变
+        int colorspace = frame->colorspace == AVCOL_SPC_BT709 ? SWS_CS_ITU709 : SWS_CS_DEFAULT;
+        bool fullRange = frame->color_range == AVCOL_RANGE_JPEG || srcFormat == AV_PIX_FMT_YUVJ420P;
+        m_swsContext = m_swsCache.get(frame->width, frame->height, srcFormat,
+                                      target.width(), target.height(), m_outputFormat,
+                                      SWS_BILINEAR, colorspace, fullRange);
+        if (!m_swsContext) {
+            reportError("无法创建图像转换上下文");
+            return false;
+        }
+    }
+
+    if (target.width() == m_outputWidth && target.height() == m_outputHeight
+            && !formatChanged && m_framePool.isValid()) {
+        return true;
+    }
+
+    // 输出缓冲区来自固定容量的对齐缓冲池，由 convertFrameToRGB 填充
+    if (!m_framePool.init(target.width(), target.height(), m_outputFormat, kFramePoolCapacity)) {
+        reportError("无法创建帧缓冲池");
+        return false;
+    }
+
+    m_outputWidth = target.width();
+    m_outputHeight = target.height();
+    return true;
+}
+
+QSize FFmpegProcessor::targetOutputSize(const QSize &source) const
+{
+    QMutexLocker locker(&m_outputMutex);
+    if (m_requestedOutputSize.isEmpty()) {
+        return source;
+    }
+
+    QSize device(qRound(m_requestedOutputSize.width() * m_devicePixelRatio),
+                 qRound(m_requestedOutputSize.height() * m_devicePixelRatio));
+    QSize target = source.scaled(device, Qt::KeepAspectRatio);
+    // 取偶数尺寸，避免色度下采样格式出现半像素
+    return QSize(qMax(2, target.width() & ~1), qMax(2, target.height() & ~1));
+}
+
+void FFmpegProcessor::setOutputSize(const QSize &size, qreal devicePixelRatio)
+{
+    QMutexLocker locker(&m_outputMutex);
+    m_requestedOutputSize = size;
+    m_devicePixelRatio = devicePixelRatio > 0.0 ? devicePixelRatio : 1.0;
+}
+
+QSize FFmpegProcessor::getOutputSize() const
+{
+    return QSize(m_outputWidth, m_outputHeight);
+}
+
+void FFmpegProcessor::setOutputFormat(OutputFormat format)
+{
+    QMutexLocker locker(&m_outputMutex);
+    m_requestedOutputFormat = format;
+}
+
+FFmpegProcessor::OutputFormat FFmpegProcessor::getOutputFormat() const
+{
+    QMutexLocker locker(&m_outputMutex);
+    return m_requestedOutputFormat;
+}
+
+bool FFmpegProcessor::passthroughYuv(const AVFrame *frame) const
+{
+    {
+        QMutexLocker locker(&m_outputMutex);
+        if (m_requestedOutputFormat != OutputFormat::YUV) {
+            return false;
+        }
+    }
+
+    switch (frame->format) {
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+    case AV_PIX_FMT_NV12:
+        return true;
+    default:
+        return false;
+    }
+}
+
+AVPixelFormat FFmpegProcessor::pixelFormat(OutputFormat format)
+{
+    // QImage 的 32 位格式按 0xAARRGGBB 整数存储，内存字节序随平台字节序变化
+    switch (format) {
+    case OutputFormat::RGB32:
+    case OutputFormat::YUV:
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        return AV_PIX_FMT_BGR0;
+#else
+        return AV_PIX_FMT_0RGB;
+#endif
+    case OutputFormat::ARGB32Premultiplied:
+        // 视频帧不透明，alpha 恒为 0xff，预乘与否数据相同
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        return AV_PIX_FMT_BGRA;
+#else
+        return AV_PIX_FMT_ARGB;
+#endif
+    case OutputFormat::RGB888:
+    default:
+        return AV_PIX_FMT_RGB24;
+    }
+}
+
+bool FFmpegProcessor::decodePacket(AVPacket *packet)
+{
+    QElapsedTimer decodeTimer;
+    decodeTimer.start();
+
+    if (!applyLowres(packet)) {
+        return false;
+    }
+    applySkipFrame();
+    int ret = avcodec_send_packet(m_codecContext, packet);
+    if (ret < 0) {
+        if (!m_probeVerified) {
+            m_probeMismatch = true;
+        }
+        reportError(QString("发送数据包到解码器失败: %1").arg(ret));
+        return false;
+    }
+
+    while (ret >= 0) {
+        ret = avcodec_receive_frame(m_codecContext, m_frame);
         if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
             return true;
         } else if (ret < 0) {
-            m_errorString = QString("接收解码帧失败: %1").arg(ret);
-            emit errorOccurred(m_errorString);
+            reportError(QString("接收解码帧失败: %1").arg(ret));
             return false;
         }
 
-        // 转换帧格式为 RGB
-        sws_scale(m_swsContext, (uint8_t const * const *)m_frame->data,
-                 m_frame->linesize, 0, m_videoHeight,
-                 m_frameRGB->data, m_frameRGB->linesize);
+        if (!m_probeVerified) {
+            verifyProbeFrame(m_frame);
+        }
 
-        // 发出帧就绪信号
-        QImage image = avFrameToQImage(m_frameRGB);
-        emit frameReady(image);
+        double pts = framePts(m_frame);
+        {
+            QMutexLocker locker(&m_syncMutex);
+            double frameDuration = m_frameRate > 0.0 ? 1000.0 / m_frameRate : 40.0;
+            m_latencyStats.decodeTime += (decodeTimer.nsecsElapsed() / 1e6 - m_latencyStats.decodeTime) / 16;
+            m_latencyStats.decoderDelay = m_codecContext->has_b_frames * frameDuration;
+        }
 
+        if (prepareFrame(pts, true) == FrameAction::Present) {
+            presentFrame(pts);
+        }
         av_frame_unref(m_frame);
     }
 
     return true;
 }
 
-void FFmpegProcessor::convertFrameToRGB()
+// 决定解码出的一帧如何处理；blocking 为 false 时不等待，未到显示时间返回 Hold
+FFmpegProcessor::FrameAction FFmpegProcessor::prepareFrame(double pts, bool blocking, double *earlyBy)
 {
-    if (m_swsContext && m_frame && m_frameRGB) {
-        sws_scale(m_swsContext, (uint8_t const * const *)m_frame->data,
-                 m_frame->linesize, 0, m_videoHeight,
-                 m_frameRGB->data, m_frameRGB->linesize);
+    // 精确跳转：目标之前的帧只解码（作为参考帧），不转换也不发出
+    if (!std::isnan(m_videoSeekTarget)) {
+        double frameDuration = m_frameRate > 0.0 ? 1.0 / m_frameRate : 0.04;
+        if (!std::isnan(pts) && pts + frameDuration * 0.5 < m_videoSeekTarget) {
+            m_seekSkippedFrames++;
+            return FrameAction::Drop;
+        }
+        m_videoSeekTarget = NAN;
+    }
+
+    // 按主时钟调度，已经迟到的帧在转换之前丢弃
+    if (blocking) {
+        return scheduleFrame(pts) ? FrameAction::Present : FrameAction::Drop;
     }
+    if (std::isnan(pts)) {
+        return FrameAction::Present;
+    }
+    double delay = frameDelay(pts);
+    if (isFrameLate(delay)) {
+        return FrameAction::Drop;
+    }
+    if (delay > 0.001) {
+        if (earlyBy) {
+            *earlyBy = delay;
+        }
+        return FrameAction::Hold;
+    }
+    recordPresented(pts, 0.0);
+    return FrameAction::Present;
 }
 
-QImage FFmpegProcessor::avFrameToQImage(AVFrame *frame)
+// 转换并放入帧信箱，超出显示帧率限制的帧不转换
+void FFmpegProcessor::presentFrame(double pts)
 {
-    if (!frame || !frame->data[0]) {
-        return QImage();
+    double interval = m_minFrameInterval;
+    if (interval > 0.0 && !std::isnan(pts) && !std::isnan(m_lastPresentedPts)
+            && pts >= m_lastPresentedPts && pts - m_lastPresentedPts < interval) {
+        QMutexLocker locker(&m_syncMutex);
+        m_syncStats.rateLimitedFrames++;
+    } else {
+        m_lastPresentedPts = pts;
+
+        // YUV 输出时直接传递解码器缓冲区的引用，转换交给渲染端
+        if (passthroughYuv(m_frame)) {
+            publishFrame(VideoFrame(m_frame));
+        }
+        // 转换帧格式为 RGB
+        else if (convertFrameToRGB()) {
+            // 放入帧信箱，只传递缓冲区引用
+            publishFrame(VideoFrame(m_frameRGB));
+        }
+    }
+
+    if (m_seekPending) {
+        finishSeek(pts);
+    }
+}
+
+double FFmpegProcessor::framePts(const AVFrame *frame) const
+{
+    if (frame->best_effort_timestamp == AV_NOPTS_VALUE) {
+        return NAN;
+    }
+    return frame->best_effort_timestamp * av_q2d(m_formatContext->streams[m_videoStreamIndex]->time_base);
+}
+
+// 等待到帧的显示时间，返回 false 表示帧已迟到应丢弃
+bool FFmpegProcessor::scheduleFrame(double pts)
+{
+    if (std::isnan(pts)) {
+        return true;
+    }
+
+    double delay = frameDelay(pts);
+    if (isFrameLate(delay)) {
+        return false;
+    }
+
+    // 分段等待以跟随主时钟，暂停和关闭时立即唤醒
+    QElapsedTimer waitTimer;
+    waitTimer.start();
+    while (delay > 0.001 && !m_videoPacketQueue.isAborted()) {
+        waitDecodeGate(m_videoPacketQueue, static_cast<unsigned long>(std::ceil(qMin(delay, 0.01) * 1000)));
+        double now = m_clock.time();
+        if (std::isnan(now)) {
+            break;
+        }
+        delay = pts - now;
+        if (qAbs(delay) > kMaxFrameDelay) {
+            break;
+        }
+    }
+
+    recordPresented(pts, waitTimer.nsecsElapsed() / 1e6);
+    return true;
+}
+
+// 帧相对主时钟的延迟（秒），正值表示还没到显示时间；时钟未就绪或时间戳跳变时重新对齐
+double FFmpegProcessor::frameDelay(double pts)
+{
+    double now = m_clock.time();
+    if (std::isnan(now)) {
+        // 没有音频时钟时以第一帧对齐系统时钟
+        m_clock.anchor(pts);
+        now = pts;
+    }
+
+    double delay = pts - now;
+    if (!m_clock.isAudioMaster() && (qAbs(delay) > kMaxFrameDelay || (m_lowLatency && delay < 0.0))) {
+        // 低延迟模式下迟到的帧不丢弃也不追赶，时钟跟随最新的帧
+        m_clock.anchor(pts);
+        delay = 0.0;
+    }
+    return delay;
+}
+
+// 晚于主时钟超过一帧半的帧直接丢弃
+bool FFmpegProcessor::isFrameLate(double delay)
+{
+    double frameDuration = m_frameRate > 0.0 ? 1.0 / m_frameRate : 0.04;
+    if (delay < -1.5 * frameDuration) {
+        QMutexLocker locker(&m_syncMutex);
+        m_syncStats.droppedLateFrames++;
+        return true;
+    }
+    return false;
+}
+
+void FFmpegProcessor::recordPresented(double pts, double waitMs)
+{
+    double now = m_clock.time();
+    QMutexLocker locker(&m_syncMutex);
+    double error = std::isnan(now) ? 0.0 : now - pts;
+    m_syncStats.lastSyncError = error;
+    m_syncStats.presentedFrames++;
+    // 指数滑动平均，近 32 帧的误差
+    m_syncStats.avgSyncError += (qAbs(error) - m_syncStats.avgSyncError) / qMin<qint64>(m_syncStats.presentedFrames, 32);
+    m_latencyStats.scheduleDelay += (waitMs - m_latencyStats.scheduleDelay) / 16;
+}
+
+// 放入帧信箱，显示端未取走的旧帧被替换
+void FFmpegProcessor::publishFrame(const VideoFrame &frame)
+{
+    m_frameMailbox.post(frame);
+
+    if (!m_firstFramePresented) {
+        m_firstFramePresented = true;
+        QMutexLocker locker(&m_syncMutex);
+        m_latencyStats.firstFrameTime = m_latencyTimer.nsecsElapsed() / 1e6;
+        qDebug() << "首帧:" << m_latencyStats.firstFrameTime << "ms";
+    }
+}
+
+FrameMailbox *FFmpegProcessor::frameMailbox()
+{
+    return &m_frameMailbox;
+}
+
+bool FFmpegProcessor::convertFrameToRGB()
+{
+    if (!m_frame || !m_frameRGB || !updateSwsContext(m_frame)) {
+        return false;
+    }
+
+    // 上一帧的缓冲区可能仍被显示端引用，这里只释放自己的引用并从池中取空闲缓冲区
+    // 池耗尽说明显示端跟不上，丢弃这一帧
+    av_frame_unref(m_frameRGB);
+    if (!m_framePool.acquire(m_frameRGB)) {
+        return false;
     }
+    m_frameRGB->pts = m_frame->best_effort_timestamp;
 
-    return QImage(frame->data[0], m_videoWidth, m_videoHeight,
-            frame->linesize[0], QImage::Format_RGB888).copy();
+    if (m_useYuvConverter) {
+        return m_yuvConverter.convert(m_frame, m_frameRGB);
+    }
+
+    sws_scale(m_swsContext, (uint8_t const * const *)m_frame->data,
+             m_frame->linesize, 0, m_frame->height,
+             m_frameRGB->data, m_frameRGB->linesize);
+    return true;
 }
 
 // 初始化音频重采样上下文
 bool FFmpegProcessor::initSwrContext()
 {
-    // 设置输出音频参数 (16位有符号PCM，立体声)
-    int64_t out_channel_layout = AV_CH_LAYOUT_STEREO;
-    AVSampleFormat out_sample_fmt = AV_SAMPLE_FMT_S16;
-    int out_sample_rate = 44100;
-    int out_channels = av_get_channel_layout_nb_channels(out_channel_layout);
+    if (m_swrContext) {
+        swr_free(&m_swrContext);
+    }
 
-    // 设置输入音频参数
-    int64_t in_channel_layout = m_audioCodecContext->channel_layout;
-    AVSampleFormat in_sample_fmt = m_audioCodecContext->sample_fmt;
-    int in_sample_rate = m_audioCodecContext->sample_rate;
+    // 输出参数与音频设备协商结果一致
+    int64_t out_channel_layout = av_get_default_channel_layout(m_audioOutChannels);
+
+    // 部分流没有声道布局，按声道数取默认布局
+    int64_t in_channel_layout = m_audioChannelLayout;
+    if (!in_channel_layout || av_get_channel_layout_nb_channels(in_channel_layout) != m_audioChannels) {
+        in_channel_layout = av_get_default_channel_layout(m_audioChannels);
+    }
 
     // 创建重采样上下文
     m_swrContext = swr_alloc_set_opts(nullptr,
-                                     out_channel_layout, out_sample_fmt, out_sample_rate,
-                                     in_channel_layout, in_sample_fmt, in_sample_rate,
+                                     out_channel_layout, m_audioOutSampleFormat, m_audioOutSampleRate,
+                                     in_channel_layout, m_audioSampleFormat, m_audioSampleRate,
                                      0, nullptr);
     if (!m_swrContext) {
-        m_errorString = "无法创建音频重采样上下文";
+        setErrorString("无法创建音频重采样上下文");
         return false;
     }
 
+    // 重采样质量与 CPU 开销：滤波器长度和相位精度
+    switch (m_audioResampleQuality) {
+    case AudioResampleQuality::Fast:
+        av_opt_set_int(m_swrContext, "filter_size", 8, 0);
+        av_opt_set_int(m_swrContext, "phase_shift", 6, 0);
+        av_opt_set_int(m_swrContext, "linear_interp", 1, 0);
+        break;
+    case AudioResampleQuality::Balanced:
+        av_opt_set_int(m_swrContext, "filter_size", 32, 0);
+        av_opt_set_int(m_swrContext, "phase_shift", 10, 0);
+        break;
+    case AudioResampleQuality::High:
+        av_opt_set_int(m_swrContext, "filter_size", 64, 0);
+        av_opt_set_int(m_swrContext, "phase_shift", 12, 0);
+        av_opt_set_int(m_swrContext, "linear_interp", 1, 0);
+        av_opt_set_double(m_swrContext, "cutoff", 0.98, 0);
+        break;
+    }
+
     if (swr_init(m_swrContext) < 0) {
-        m_errorString = "无法初始化音频重采样上下文";
+        setErrorString("无法初始化音频重采样上下文");
         return false;
     }
 
@@ -545,15 +1977,29 @@ bool FFmpegProcessor::initSwrContext()
 
 void FFmpegProcessor::cleanup()
 {
-    if (m_rgbBuffer) {
-        av_free(m_rgbBuffer);
-        m_rgbBuffer = nullptr;
+    // 先停止解码线程，再释放它们使用的资源
+    stopDecodeThreads();
+    m_probeEntry.clear();
+    m_probeVerified = true;
+    m_frameMailbox.clear();
+    m_clock.setAudioClockSource(MediaClock::AudioClockSource());
+    m_audioOutput.close();
+    m_keyframeIndex.clear();
+    if (m_seekIndexer) {
+        // 已扫描部分写入检查点，下次打开时继续
+        m_seekIndexer->stop();
+        delete m_seekIndexer;
+        m_seekIndexer = nullptr;
     }
+    m_seekIndexFile.close();
+    m_videoSeekTarget = NAN;
+    m_audioSeekTarget = NAN;
+    m_seekPending = false;
 
-    if (m_swsContext) {
-        sws_freeContext(m_swsContext);
-        m_swsContext = nullptr;
-    }
+    m_swsCache.clear();
+    m_swsContext = nullptr;
+
+    m_framePool.release();
 
     if (m_frame) {
         av_frame_free(&m_frame);
@@ -570,6 +2016,14 @@ void FFmpegProcessor::cleanup()
         m_packet = nullptr;
     }
 
+    if (m_decodePacket) {
+        av_packet_free(&m_decodePacket);
+    }
+
+    if (m_audioDecodePacket) {
+        av_packet_free(&m_audioDecodePacket);
+    }
+
     if (m_codecContext) {
         avcodec_free_context(&m_codecContext);
         m_codecContext = nullptr;
@@ -583,6 +2037,10 @@ void FFmpegProcessor::cleanup()
     m_videoStreamIndex = -1;
     m_videoWidth = 0;
     m_videoHeight = 0;
+    m_decodedWidth = 0;
+    m_decodedHeight = 0;
+    m_outputWidth = 0;
+    m_outputHeight = 0;
     m_frameRate = 0.0;
     m_codecName.clear();
 
@@ -611,5 +2069,8 @@ void FFmpegProcessor::cleanup()
     m_audioStreamIndex = -1;
     m_audioSampleRate = 0;
     m_audioChannels = 0;
+    m_audioChannelLayout = 0;
     m_audioCodecName.clear();
+
+    publishStreamInfo();
 }
@@ -5,6 +5,25 @@
 #include <QImage>
 #include <QString>
 #include <QMutex>
+#include <QSize>
+#include <QThread>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "packetqueue.h"
+#include "videoframe.h"
+#include "framepool.h"
+#include "mediaclock.h"
+#include "swscache.h"
+#include "yuvconvert.h"
+#include "audiooutput.h"
+#include "audioconvert.h"
+#include "keyframeindex.h"
+#include "seekindexer.h"
+#include "probecache.h"
+#include "framemailbox.h"
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -29,6 +48,93 @@ public:
         Error
     };
 
+    // 解码线程配置：Live 低延迟（切片线程，无额外帧延迟），File 高吞吐（帧线程）
+    enum class DecodeProfile {
+        Auto,
+        Live,
+        File
+    };
+
+    // 打开流的方式：LowLatency 缩短探测、关闭解复用缓冲、低延迟解码
+    enum class OpenProfile {
+        Auto,       // 实时流（rtsp/rtp/udp/srt/rtmp）使用 LowLatency，其余 Standard
+        Standard,
+        LowLatency
+    };
+
+    // 需要重采样时的质量与 CPU 开销取舍，格式与设备一致时不经过重采样
+    enum class AudioResampleQuality {
+        Fast,       // 短滤波器 + 线性插值，CPU 最低
+        Balanced,   // swresample 默认参数
+        High        // 长滤波器，适合音乐
+    };
+
+    // 输出像素格式，默认使用光栅绘制引擎原生的 32 位格式，避免绘制时再转换一次
+    enum class OutputFormat {
+        RGB32,                  // QImage::Format_RGB32
+        ARGB32Premultiplied,    // QImage::Format_ARGB32_Premultiplied
+        RGB888,                 // QImage::Format_RGB888
+        YUV                     // 直接输出解码平面（yuv420p/nv12），由 GPU 渲染端转换；其他格式按 RGB32 输出
+    };
+
+    // 音视频同步统计，同步误差为帧实际发出时间减去 pts（正值表示晚于主时钟）
+    struct SyncStats {
+        double lastSyncError = 0.0;
+        double avgSyncError = 0.0;
+        qint64 presentedFrames = 0;
+        qint64 droppedLateFrames = 0;
+        qint64 rateLimitedFrames = 0;   // 超出显示帧率限制、解码后未转换的帧
+        bool audioMaster = false;
+    };
+
+    // 跳转方式
+    enum class SeekMode {
+        Keyframe,   // 停在目标之前最近的关键帧，最快
+        Accurate    // 从关键帧解码到目标时间，中间的帧不转换也不发出
+    };
+
+    // 跳转统计，延迟为调用 seek 到目标帧发出的时间（毫秒）
+    struct SeekStats {
+        qint64 seeks = 0;
+        double lastLatency = 0.0;
+        int lastSkippedFrames = 0;
+        bool lastUsedIndex = false;
+    };
+
+    // 各环节带来的延迟（毫秒），用于调整端到端延迟
+    struct LatencyStats {
+        double connectTime = 0.0;       // avformat_open_input
+        double probeTime = 0.0;         // avformat_find_stream_info
+        double firstFrameTime = 0.0;    // 开始打开到第一帧发出
+        double demuxBuffer = 0.0;       // 视频包队列中缓存的时长
+        double decodeTime = 0.0;        // 送包到取出帧的平均耗时
+        double decoderDelay = 0.0;      // 解码器重排序引入的延迟（has_b_frames 帧）
+        double scheduleDelay = 0.0;     // 按时钟等待的平均时长
+        double displayDelay = 0.0;      // 帧放入信箱到显示端取走的平均时长
+        double audioOutputDelay = 0.0;  // 音频设备缓冲
+        double estimatedLatency = 0.0;  // 以上各环节之和（不含连接和探测）
+        qint64 displayDroppedFrames = 0; // 显示端未取走就被新帧替换的帧
+        bool lowLatency = false;
+        bool probeFromCache = false;    // 使用了缓存的探测结果
+    };
+
+    // 流信息快照：打开流、分辨率或音频格式变化、关闭时整体替换发布，读取方不加锁
+    struct StreamInfo {
+        QString url;
+        int videoStreamIndex = -1;
+        int videoWidth = 0;     // 编码尺寸，不随 lowres 变化
+        int videoHeight = 0;
+        int decodedWidth = 0;   // 解码输出尺寸，lowres 时按级别缩小
+        int decodedHeight = 0;
+        double frameRate = 0.0;
+        QString codecName;
+        int audioStreamIndex = -1;
+        int audioSampleRate = 0;
+        int audioChannels = 0;
+        QString audioCodecName;
+        double duration = 0.0;  // 秒，未知时为 0
+    };
+
     explicit FFmpegProcessor(QObject *parent = nullptr);
     ~FFmpegProcessor();
 
@@ -37,19 +143,75 @@ public:
     void closeStream();
     bool readFrame();
     QImage getCurrentFrame();
+    // 解码帧通过单槽信箱交给显示端，显示端收到 frameAvailable 后取最新帧
+    FrameMailbox *frameMailbox();
 
-    // 流信息
+    // 流信息，可在任意线程调用
+    StreamInfo getStreamInfo() const;
     StreamStatus getStatus() const;
+    // 解复用已读到流末尾（跳转后清除）
+    bool isEndOfStream() const;
     QString getErrorString() const;
     int getVideoWidth() const;
     int getVideoHeight() const;
     double getFrameRate() const;
     QString getCodecName() const;
 
+    // 解码线程配置，需在 openStream 之前设置
+    void setDecodeProfile(DecodeProfile profile);
+    DecodeProfile getDecodeProfile() const;
+    // 解码线程数，0 表示按 CPU 核心数自动检测
+    void setDecodeThreadCount(int count);
+    int getDecodeThreadCount() const;
+
+    // 打开方式，需在 openStream 之前设置
+    void setOpenProfile(OpenProfile profile);
+    OpenProfile getOpenProfile() const;
+    // 同一 URL 再次打开时使用缓存的探测结果，默认开启
+    void setProbeCacheEnabled(bool enabled);
+    bool isProbeCacheEnabled() const;
+    LatencyStats getLatencyStats() const;
+
+    // 中断当前会话中阻塞的网络 I/O 和满队列上的写入，可在任意线程调用；之后的读取和打开立即失败，直到 clearInterrupt
+    void interrupt();
+    void clearInterrupt();
+    bool isInterrupted() const;
+    // 单次阻塞 I/O 的最长时间（毫秒），超时后同样中断
+    void setIoTimeouts(int openTimeoutMs, int readTimeoutMs);
+
+    // 协作模式：不创建解码线程，由外部调度器（StreamScheduler）驱动，需在 openStream 之前设置
+    // 读取线程调用 readFrame/seek，工作线程调用 step，两者由调度器保证不与 seek 同时进行
+    void setCooperative(bool cooperative);
+    bool isCooperative() const;
+    // 只解码队列中已有的数据包，不阻塞；返回 0 表示还有工作，正数为建议的等待时间（微秒），
+    // -1 表示队列已空（等待读取线程）、已暂停、已停止或播放结束
+    qint64 step(int packetBudget);
+    // 读取线程的就绪判断：可以读取（正在播放、队列未满、未到末尾），以及是否有待解码的数据
+    bool canDemux() const;
+    bool hasDecodableData() const;
+    // 探测缓存与码流不符，需要在该流停止解码后调用 reopen
+    bool needsReopen() const;
+    bool reopen();
+    // 显示帧率上限，0 表示不限；超出的帧解码后不转换，可在任意线程调用
+    void setFrameRateLimit(double fps);
+    double getFrameRateLimit() const;
+    // 跳过非参考帧的解码（后台画面），可在任意线程调用，下一个数据包生效
+    void setSkipNonReference(bool skip);
+    // 解码阶段降分辨率（每级宽高减半，0~3），可在任意线程调用，下一个关键帧生效；解码器不支持时忽略
+    void setLowres(int level);
+    int getLowres() const;
+    // 关闭时不解码音频（多画面等场景），需在 openStream 之前设置
+    void setAudioEnabled(bool enabled);
+    bool isAudioEnabled() const;
+
     // 控制操作
     void pause();
     void resume();
+    // 必须在解复用线程（调用 readFrame 的线程）中调用
     void seek(double seconds);
+    void setSeekMode(SeekMode mode);
+    SeekMode getSeekMode() const;
+    SeekStats getSeekStats() const;
 
 public:
     // 新增音频相关函数
@@ -62,26 +224,94 @@ public:
     int getAudioChannels() const;
     QString getAudioCodecName() const;
 
+    // 数据包队列深度，用于定位解复用/解码瓶颈
+    PacketQueue::Stats getVideoQueueStats() const;
+    PacketQueue::Stats getAudioQueueStats() const;
+    void setPacketQueueLimits(qint64 maxBytes, double maxDuration);
+
+    // 音视频同步
+    SyncStats getSyncStats() const;
+    // 音频输出缓冲状态（欠载/溢出次数）
+    AudioOutput::Stats getAudioOutputStats() const;
+
+    // 输出尺寸：按显示区域（逻辑像素 * 设备像素比）保持宽高比缩放，空尺寸表示原始分辨率
+    void setOutputSize(const QSize &size, qreal devicePixelRatio);
+    QSize getOutputSize() const;
+
+    void setOutputFormat(OutputFormat format);
+    OutputFormat getOutputFormat() const;
+
+    // 下次打开流时生效
+    void setAudioResampleQuality(AudioResampleQuality quality);
+    AudioResampleQuality getAudioResampleQuality() const;
+
 signals:
-    void frameReady(const QImage &frame);
     void statusChanged(int status);
     void errorOccurred(const QString &errorMessage);
 
     // 新增音频相关信号
     void audioReady(const QByteArray &audioData);
     void audioFormatChanged(int sampleRate, int channels);
+    void seekFinished(double position, double latencyMs);
+    void seekIndexProgress(int percent);
 
 private:
     void initFFmpeg();
+    void setStatus(StreamStatus status);
+    void setErrorString(const QString &message);
+    void reportError(const QString &message);
+    void publishStreamInfo();
+    void updateStreamInfo(const std::function<void(StreamInfo &)> &update);
     void cleanup();
     bool initCodec();
+    void applyDecodeProfile(const AVCodec *codec);
+    DecodeProfile resolveDecodeProfile() const;
+    bool isLiveUrl() const;
+    void applyOpenProfile(AVDictionary **options);
+    void publishFrame(const VideoFrame &frame);
+    bool probeStreams();
+    static int interruptCallback(void *opaque);
+    void armIoDeadline(int timeoutMs);
+    void verifyProbeFrame(const AVFrame *frame);
     bool initSwsContext();
+    bool updateSwsContext(const AVFrame *frame);
+    QSize targetOutputSize(const QSize &source) const;
+    static AVPixelFormat pixelFormat(OutputFormat format);
+    bool passthroughYuv(const AVFrame *frame) const;
     bool decodePacket(AVPacket *packet);
-    void convertFrameToRGB();
-    QImage avFrameToQImage(AVFrame *frame);
+    bool convertFrameToRGB();
+    double framePts(const AVFrame *frame) const;
+    bool scheduleFrame(double pts);
+    double frameDelay(double pts);
+    bool isFrameLate(double delay);
+    void recordPresented(double pts, double waitMs);
+
+    // 解码出的一帧：显示、丢弃，或（非阻塞时）未到显示时间先保留
+    enum class FrameAction {
+        Present,
+        Drop,
+        Hold
+    };
+    FrameAction prepareFrame(double pts, bool blocking, double *earlyBy = nullptr);
+    void presentFrame(double pts);
+    void applySkipFrame();
+    bool applyLowres(const AVPacket *packet);
+    void finishSeek(double pts);
+    void openSeekIndex();
 
     // 新增音频相关私有函数
+    bool openAudioDecoder();
     bool initSwrContext();
+    bool reserveAudioBuffer(int size);
+
+    // 解码线程
+    void startDecodeThreads();
+    void stopDecodeThreads();
+    void videoDecodeLoop();
+    void audioDecodeLoop();
+    void waitDecodeGate(const PacketQueue &queue, unsigned long timeoutMs);
+    qint64 videoStep(int packetBudget);
+    qint64 audioStep(int packetBudget);
 
     // FFmpeg 相关变量
     AVFormatContext *m_formatContext;
@@ -89,20 +319,67 @@ private:
     AVFrame *m_frame;
     AVFrame *m_frameRGB;
     AVPacket *m_packet;
+    // 当前帧使用的转换上下文，归 m_swsCache 所有
     SwsContext *m_swsContext;
+    SwsContextCache m_swsCache;
+    // 不缩放且格式受支持时使用手写 SIMD 内核代替 sws_scale
+    YuvToRgbConverter m_yuvConverter;
+    bool m_useYuvConverter;
+    AVPixelFormat m_outputFormat;
+    // 转换输出缓冲池，显示端释放帧后缓冲区自动归还
+    FramePool m_framePool;
+    FrameMailbox m_frameMailbox;
+
+    // 输出尺寸
+    QSize m_requestedOutputSize;
+    OutputFormat m_requestedOutputFormat;
+    qreal m_devicePixelRatio;
+    int m_outputWidth;
+    int m_outputHeight;
+    mutable QMutex m_outputMutex;
 
-    // 状态变量
-    StreamStatus m_status;
-    QString m_errorString;
+    // 状态变量：状态为原子量，错误信息和流信息快照用 shared_ptr 原子替换
+    std::atomic<StreamStatus> m_status;
+    std::shared_ptr<const QString> m_errorString;
+    std::shared_ptr<const StreamInfo> m_streamInfo;
+    // 串行化快照的写入方
+    QMutex m_infoMutex;
     int m_videoStreamIndex;
-    uint8_t *m_rgbBuffer;
 
-    // 视频信息
+    // 视频信息（打开流和解码线程维护，对外通过 m_streamInfo 发布）
     int m_videoWidth;
     int m_videoHeight;
+    // 最近一帧的解码尺寸，只在解码线程中访问
+    int m_decodedWidth;
+    int m_decodedHeight;
     double m_frameRate;
     QString m_codecName;
 
+    // 解码线程配置
+    QString m_url;
+    DecodeProfile m_decodeProfile;
+    int m_decodeThreadCount;
+    OpenProfile m_openProfile;
+    bool m_lowLatency;
+
+    // 延迟统计：各时间点取自 m_latencyTimer（openStream 开始计时）
+    QElapsedTimer m_latencyTimer;
+    LatencyStats m_latencyStats;
+    bool m_firstFramePresented;
+
+    // I/O 中断：取消标志和当前阻塞调用的截止时间（m_ioTimer 的纳秒数，0 表示不限）
+    std::atomic<bool> m_interrupted;
+    std::atomic<qint64> m_ioDeadline;
+    QElapsedTimer m_ioTimer;
+    int m_openTimeout;
+    int m_readTimeout;
+
+    // 探测缓存：使用缓存打开时，第一帧解码前后与缓存核对，不一致则完整探测后重新打开
+    bool m_probeCacheEnabled;
+    QSharedPointer<const ProbeCache::Entry> m_probeEntry;
+    std::atomic<bool> m_probeVerified;
+    std::atomic<bool> m_probeMismatch;
+
     // 新增音频相关成员变量
     int m_audioStreamIndex;
     AVCodecContext *m_audioCodecContext;
@@ -116,6 +393,68 @@ private:
     int m_audioChannels;
     QString m_audioCodecName;
     AVSampleFormat m_audioSampleFormat;
+    int64_t m_audioChannelLayout;
+
+    // SDL 音频输出，打开失败时退回 audioReady 信号
+    AudioOutput m_audioOutput;
+
+    // 解码样本到设备样本的转换方式
+    enum class AudioPath {
+        Passthrough,    // 格式完全一致，直接写入
+        Interleave,     // 只差平面/交错排列
+        Resample        // 采样率、声道数或样本类型不同，经过 swresample
+    };
+    static const char *audioPathName(AudioPath path);
+
+    int m_audioOutSampleRate;
+    int m_audioOutChannels;
+    AVSampleFormat m_audioOutSampleFormat;
+    AudioPath m_audioPath;
+    AudioResampleQuality m_audioResampleQuality;
+    PlanarInterleaver m_interleaver;
+
+    // 解复用线程写入、解码线程读取的数据包队列
+    PacketQueue m_videoPacketQueue;
+    PacketQueue m_audioPacketQueue;
+    QThread *m_videoDecodeThread;
+    QThread *m_audioDecodeThread;
+    // 解码线程在暂停和帧定时时等待，状态变化和队列中止时唤醒
+    QMutex m_decodeGateMutex;
+    QWaitCondition m_decodeGate;
+    bool m_demuxEof;
+
+    // 协作模式：m_heldFrame 表示 m_frame 中有一帧未到显示时间，下个时间片再处理
+    bool m_cooperative;
+    bool m_audioDecoding;
+    AVPacket *m_decodePacket;
+    AVPacket *m_audioDecodePacket;
+    bool m_heldFrame;
+    // 显示帧率限制（最小帧间隔，秒）和跳过非参考帧
+    std::atomic<double> m_minFrameInterval;
+    double m_lastPresentedPts;
+    std::atomic<bool> m_skipNonReference;
+    std::atomic<int> m_lowres;
+    int m_codecMaxLowres;
+    bool m_audioEnabled;
+
+    // 跳转：关键帧索引，以及精确跳转时各解码线程要跳过的目标时间（NAN 表示无）
+    KeyframeIndex m_keyframeIndex;
+    // 本地文件的旁路索引（内存映射），尚未建立时由后台线程建立
+    SeekIndexFile m_seekIndexFile;
+    SeekIndexer *m_seekIndexer;
+    SeekMode m_seekMode;
+    double m_videoSeekTarget;
+    double m_audioSeekTarget;
+    bool m_seekPending;
+    int m_seekSkippedFrames;
+    bool m_seekUsedIndex;
+    QElapsedTimer m_seekTimer;
+    SeekStats m_seekStats;
+
+    // 播放主时钟和同步统计
+    MediaClock m_clock;
+    SyncStats m_syncStats;
+    mutable QMutex m_syncMutex;
 
     // 线程安全
     mutable QMutex m_mutex;
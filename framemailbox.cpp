@@ -0,0 +1,72 @@
+#include "framemailbox.h"
+
+FrameMailbox::FrameMailbox(QObject *parent)
+    : QObject(parent),
+      m_slot(nullptr),
+      m_posted(0),
+      m_taken(0),
+      m_coalesced(0),
+      m_lastDelay(0.0),
+      m_avgDelay(0.0)
+{
+    m_timer.start();
+}
+
+FrameMailbox::~FrameMailbox()
+{
+    delete m_slot.exchange(nullptr);
+}
+
+void FrameMailbox::post(const VideoFrame &frame)
+{
+    Slot *slot = new Slot{ frame, m_timer.nsecsElapsed() };
+    Slot *previous = m_slot.exchange(slot, std::memory_order_acq_rel);
+    m_posted++;
+
+    if (previous) {
+        // 旧帧的缓冲区在这里归还
+        m_coalesced++;
+        delete previous;
+    } else {
+        emit frameAvailable();
+    }
+}
+
+bool FrameMailbox::take(VideoFrame *frame)
+{
+    Slot *slot = m_slot.exchange(nullptr, std::memory_order_acq_rel);
+    if (!slot) {
+        return false;
+    }
+
+    *frame = slot->frame;
+    double delay = (m_timer.nsecsElapsed() - slot->postedNs) / 1e6;
+    delete slot;
+
+    qint64 taken = ++m_taken;
+    m_lastDelay = delay;
+    // 近 16 帧的滑动平均
+    m_avgDelay = m_avgDelay + (delay - m_avgDelay) / qMin<qint64>(taken, 16);
+    return true;
+}
+
+void FrameMailbox::clear()
+{
+    delete m_slot.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+bool FrameMailbox::hasFrame() const
+{
+    return m_slot.load(std::memory_order_acquire) != nullptr;
+}
+
+FrameMailbox::Stats FrameMailbox::stats() const
+{
+    Stats stats;
+    stats.posted = m_posted;
+    stats.taken = m_taken;
+    stats.coalesced = m_coalesced;
+    stats.lastDelay = m_lastDelay;
+    stats.avgDelay = m_avgDelay;
+    return stats;
+}
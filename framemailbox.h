@@ -0,0 +1,56 @@
+#ifndef FRAMEMAILBOX_H
+#define FRAMEMAILBOX_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <atomic>
+#include "videoframe.h"
+
+// 解码线程与显示端之间的单槽信箱：新帧直接替换尚未取走的旧帧，内存和延迟都不会随显示端卡顿累积
+// 槽位用原子指针交换，不加锁；只在槽位由空变满时发出一次 frameAvailable，事件队列中最多一个通知
+class FrameMailbox : public QObject
+{
+    Q_OBJECT
+public:
+    struct Stats {
+        qint64 posted = 0;
+        qint64 taken = 0;
+        qint64 coalesced = 0;       // 未被取走就被新帧替换
+        double lastDelay = 0.0;     // 放入到取走的时间（毫秒）
+        double avgDelay = 0.0;
+    };
+
+    explicit FrameMailbox(QObject *parent = nullptr);
+    ~FrameMailbox();
+
+    // 生产端（解码线程）
+    void post(const VideoFrame &frame);
+    // 消费端（GUI 线程），没有新帧时返回 false
+    bool take(VideoFrame *frame);
+    // 丢弃尚未取走的帧（关闭流、切换流时）
+    void clear();
+
+    bool hasFrame() const;
+    Stats stats() const;
+
+signals:
+    void frameAvailable();
+
+private:
+    struct Slot {
+        VideoFrame frame;
+        qint64 postedNs;
+    };
+
+    std::atomic<Slot *> m_slot;
+    QElapsedTimer m_timer;
+
+    std::atomic<qint64> m_posted;
+    std::atomic<qint64> m_taken;
+    std::atomic<qint64> m_coalesced;
+    // 只由消费端写入
+    std::atomic<double> m_lastDelay;
+    std::atomic<double> m_avgDelay;
+};
+
+#endif // FRAMEMAILBOX_H
@@ -0,0 +1,206 @@
+#include "framepool.h"
+
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libavutil/mem.h>
+}
+
+struct FramePool::Slot
+{
+    uint8_t *raw;
+    uint8_t *data;
+    QSharedPointer<PoolData> pool;
+};
+
+struct FramePool::PoolData
+{
+    QMutex mutex;
+    QVector<Slot *> freeSlots;
+    int width = 0;
+    int height = 0;
+    AVPixelFormat format = AV_PIX_FMT_NONE;
+    int linesize[4] = { 0, 0, 0, 0 };
+    int bufferSize = 0;
+    int capacity = 0;
+    int allocated = 0;
+    int outstanding = 0;
+    qint64 exhausted = 0;
+    bool closed = false;
+};
+
+static void freeSlotMemory(uint8_t *raw)
+{
+    av_free(raw);
+}
+
+FramePool::FramePool()
+{
+}
+
+FramePool::~FramePool()
+{
+    release();
+}
+
+bool FramePool::init(int width, int height, AVPixelFormat format, int capacity)
+{
+    release();
+
+    if (width <= 0 || height <= 0 || format == AV_PIX_FMT_NONE || capacity <= 0) {
+        return false;
+    }
+
+    QSharedPointer<PoolData> pool(new PoolData);
+    pool->width = width;
+    pool->height = height;
+    pool->format = format;
+    pool->capacity = capacity;
+
+    // 每行跨度补齐到 64 字节，SIMD 按行处理时无需处理尾部
+    if (av_image_fill_linesizes(pool->linesize, format, width) < 0) {
+        return false;
+    }
+    for (int i = 0; i < 4; i++) {
+        pool->linesize[i] = FFALIGN(pool->linesize[i], Alignment);
+    }
+
+    uint8_t *planes[4] = { nullptr, nullptr, nullptr, nullptr };
+    int size = av_image_fill_pointers(planes, format, height, nullptr, pool->linesize);
+    if (size < 0) {
+        return false;
+    }
+    // 尾部留出填充，允许 SIMD 读越过最后一行
+    pool->bufferSize = size + Alignment;
+
+    m_pool = pool;
+    return true;
+}
+
+void FramePool::release()
+{
+    if (!m_pool) {
+        return;
+    }
+
+    QMutexLocker locker(&m_pool->mutex);
+    m_pool->closed = true;
+    for (Slot *slot : m_pool->freeSlots) {
+        freeSlotMemory(slot->raw);
+        slot->pool.reset();
+        delete slot;
+    }
+    m_pool->freeSlots.clear();
+    locker.unlock();
+
+    m_pool.reset();
+}
+
+bool FramePool::acquire(AVFrame *frame)
+{
+    if (!m_pool || !frame) {
+        return false;
+    }
+
+    Slot *slot = nullptr;
+    {
+        QMutexLocker locker(&m_pool->mutex);
+        if (!m_pool->freeSlots.isEmpty()) {
+            slot = m_pool->freeSlots.takeLast();
+        } else if (m_pool->allocated < m_pool->capacity) {
+            // 按需分配，总量不超过容量
+            uint8_t *raw = static_cast<uint8_t *>(av_malloc(m_pool->bufferSize + Alignment));
+            if (!raw) {
+                return false;
+            }
+            slot = new Slot;
+            slot->raw = raw;
+            slot->data = reinterpret_cast<uint8_t *>(FFALIGN(reinterpret_cast<uintptr_t>(raw), Alignment));
+            slot->pool = m_pool;
+            m_pool->allocated++;
+        } else {
+            // 所有缓冲区都还在显示端，丢弃这一帧而不是继续申请内存
+            m_pool->exhausted++;
+            return false;
+        }
+        m_pool->outstanding++;
+    }
+
+    AVBufferRef *buf = av_buffer_create(slot->data, m_pool->bufferSize, returnSlot, slot, 0);
+    if (!buf) {
+        returnSlot(slot, slot->data);
+        return false;
+    }
+
+    av_frame_unref(frame);
+    frame->buf[0] = buf;
+    frame->format = m_pool->format;
+    frame->width = m_pool->width;
+    frame->height = m_pool->height;
+    av_image_fill_pointers(frame->data, m_pool->format, m_pool->height, slot->data, m_pool->linesize);
+    for (int i = 0; i < 4; i++) {
+        frame->linesize[i] = m_pool->linesize[i];
+    }
+    frame->extended_data = frame->data;
+    return true;
+}
+
+void FramePool::returnSlot(void *opaque, uint8_t *data)
+{
+    Q_UNUSED(data)
+    Slot *slot = static_cast<Slot *>(opaque);
+    QSharedPointer<PoolData> pool = slot->pool;
+
+    QMutexLocker locker(&pool->mutex);
+    pool->outstanding--;
+    if (pool->closed) {
+        // 缓冲池已重建或释放，直接释放内存
+        freeSlotMemory(slot->raw);
+        slot->pool.reset();
+        delete slot;
+        return;
+    }
+    pool->freeSlots.append(slot);
+}
+
+bool FramePool::isValid() const
+{
+    return !m_pool.isNull();
+}
+
+int FramePool::width() const
+{
+    return m_pool ? m_pool->width : 0;
+}
+
+int FramePool::height() const
+{
+    return m_pool ? m_pool->height : 0;
+}
+
+AVPixelFormat FramePool::format() const
+{
+    return m_pool ? m_pool->format : AV_PIX_FMT_NONE;
+}
+
+int FramePool::capacity() const
+{
+    return m_pool ? m_pool->capacity : 0;
+}
+
+int FramePool::outstanding() const
+{
+    if (!m_pool) {
+        return 0;
+    }
+    QMutexLocker locker(&m_pool->mutex);
+    return m_pool->outstanding;
+}
+
+qint64 FramePool::exhaustedCount() const
+{
+    if (!m_pool) {
+        return 0;
+    }
+    QMutexLocker locker(&m_pool->mutex);
+    return m_pool->exhausted;
+}
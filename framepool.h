@@ -0,0 +1,47 @@
+#ifndef FRAMEPOOL_H
+#define FRAMEPOOL_H
+
+#include <QMutex>
+#include <QSharedPointer>
+#include <QVector>
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+// 固定容量的帧缓冲池，缓冲区首地址和每行跨度都按 64 字节对齐
+// 缓冲区以 AVBufferRef 形式交给 AVFrame，最后一个引用释放时自动归还
+class FramePool
+{
+public:
+    static const int Alignment = 64;
+
+    FramePool();
+    ~FramePool();
+
+    // 按尺寸和像素格式重建缓冲池，capacity 为同时在外的最大缓冲区数
+    bool init(int width, int height, AVPixelFormat format, int capacity);
+    // 释放缓冲池，尚未归还的缓冲区在归还时释放
+    void release();
+
+    // 取一个空闲缓冲区填充 frame 的 data/linesize/buf，池已耗尽时返回 false
+    bool acquire(AVFrame *frame);
+
+    bool isValid() const;
+    int width() const;
+    int height() const;
+    AVPixelFormat format() const;
+    int capacity() const;
+    int outstanding() const;
+    qint64 exhaustedCount() const;
+
+private:
+    struct PoolData;
+    struct Slot;
+
+    static void returnSlot(void *opaque, uint8_t *data);
+
+    QSharedPointer<PoolData> m_pool;
+};
+
+#endif // FRAMEPOOL_H
@@ -0,0 +1,406 @@
+#include "glvideowidget.h"
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QGenericMatrix>
+#include <QDebug>
+#include <cstring>
+
+// GL 2.0/ES 2.0 头文件中可能缺少的常量
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#endif
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW 0x88E0
+#endif
+#ifndef GL_UNPACK_ROW_LENGTH
+#define GL_UNPACK_ROW_LENGTH 0x0CF2
+#endif
+#ifndef GL_MAP_WRITE_BIT
+#define GL_MAP_WRITE_BIT 0x0002
+#endif
+#ifndef GL_MAP_INVALIDATE_BUFFER_BIT
+#define GL_MAP_INVALIDATE_BUFFER_BIT 0x0008
+#endif
+
+static const char *kVertexShader =
+    "attribute vec4 a_position;\n"
+    "attribute vec2 a_texCoord;\n"
+    "varying vec2 v_texCoord;\n"
+    "void main() {\n"
+    "    gl_Position = a_position;\n"
+    "    v_texCoord = a_texCoord;\n"
+    "}\n";
+
+// u_layout: 0 = I420（三个亮度纹理），1 = NV12（UV 放在 luminance/alpha），2 = RGB32（按 BGRA 字节上传）
+static const char *kFragmentShader =
+    "#ifdef GL_ES\n"
+    "precision mediump float;\n"
+    "#endif\n"
+    "varying vec2 v_texCoord;\n"
+    "uniform sampler2D u_texY;\n"
+    "uniform sampler2D u_texU;\n"
+    "uniform sampler2D u_texV;\n"
+    "uniform int u_layout;\n"
+    "uniform mat3 u_colorMatrix;\n"
+    "uniform vec3 u_colorOffset;\n"
+    "void main() {\n"
+    "    if (u_layout == 2) {\n"
+    "        gl_FragColor = vec4(texture2D(u_texY, v_texCoord).bgr, 1.0);\n"
+    "        return;\n"
+    "    }\n"
+    "    vec3 yuv;\n"
+    "    yuv.x = texture2D(u_texY, v_texCoord).r;\n"
+    "    if (u_layout == 1) {\n"
+    "        yuv.yz = texture2D(u_texU, v_texCoord).ra;\n"
+    "    } else {\n"
+    "        yuv.y = texture2D(u_texU, v_texCoord).r;\n"
+    "        yuv.z = texture2D(u_texV, v_texCoord).r;\n"
+    "    }\n"
+    "    vec3 rgb = u_colorMatrix * (yuv - u_colorOffset);\n"
+    "    gl_FragColor = vec4(clamp(rgb, 0.0, 1.0), 1.0);\n"
+    "}\n";
+
+static const GLfloat kVertices[] = {
+    -1.0f, -1.0f,
+     1.0f, -1.0f,
+    -1.0f,  1.0f,
+     1.0f,  1.0f
+};
+
+// 纹理第 0 行是图像顶部
+static const GLfloat kTexCoords[] = {
+    0.0f, 1.0f,
+    1.0f, 1.0f,
+    0.0f, 0.0f,
+    1.0f, 0.0f
+};
+
+GLVideoWidget::GLVideoWidget(QWidget *parent)
+    : QOpenGLWidget(parent),
+      m_extraFunctions(nullptr),
+      m_glFailed(false),
+      m_planeCount(0),
+      m_layout(Layout::None),
+      m_frameWidth(0),
+      m_frameHeight(0),
+      m_usePbo(false),
+      m_pboIndex(0),
+      m_hasUnpackRowLength(false),
+      m_hasPendingFrame(false)
+{
+    memset(m_pbo, 0, sizeof(m_pbo));
+    memset(m_colorMatrix, 0, sizeof(m_colorMatrix));
+    memset(m_colorOffset, 0, sizeof(m_colorOffset));
+}
+
+GLVideoWidget::~GLVideoWidget()
+{
+    makeCurrent();
+    releaseGL();
+    doneCurrent();
+}
+
+bool GLVideoWidget::isSupportedFormat(AVPixelFormat format)
+{
+    switch (format) {
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+    case AV_PIX_FMT_NV12:
+    case AV_PIX_FMT_BGRA:
+    case AV_PIX_FMT_BGR0:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void GLVideoWidget::presentFrame(const VideoFrame &frame)
+{
+    if (frame.isNull() || !isSupportedFormat(frame.format())) {
+        return;
+    }
+
+    // 只保留最新一帧，上传在 paintGL 中进行
+    m_pendingFrame = frame;
+    m_hasPendingFrame = true;
+    update();
+}
+
+void GLVideoWidget::initializeGL()
+{
+    initializeOpenGLFunctions();
+
+    QOpenGLContext *ctx = context();
+    if (!ctx || !ctx->isValid() || !initShaders()) {
+        qDebug() << "OpenGL 不可用，切换到 RGB 渲染";
+        m_glFailed = true;
+        QMetaObject::invokeMethod(this, "glUnavailable", Qt::QueuedConnection);
+        return;
+    }
+
+    // GL 3.0 / ES 3.0 起支持 glMapBufferRange，用 PBO 异步上传
+    int major = ctx->format().majorVersion();
+    m_usePbo = major >= 3;
+    m_hasUnpackRowLength = !ctx->isOpenGLES() || major >= 3;
+    if (m_usePbo) {
+        m_extraFunctions = ctx->extraFunctions();
+        glGenBuffers(6, &m_pbo[0][0]);
+    }
+
+    qDebug() << "OpenGL 视频渲染:" << reinterpret_cast<const char *>(glGetString(GL_RENDERER))
+             << "PBO" << m_usePbo;
+}
+
+void GLVideoWidget::resizeGL(int w, int h)
+{
+    Q_UNUSED(w)
+    Q_UNUSED(h)
+}
+
+void GLVideoWidget::paintGL()
+{
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    if (m_glFailed) {
+        return;
+    }
+
+    if (m_hasPendingFrame) {
+        uploadFrame(m_pendingFrame.avFrame());
+        // 上传后立即释放引用，缓冲区归还给解码器
+        m_pendingFrame = VideoFrame();
+        m_hasPendingFrame = false;
+    }
+
+    if (m_layout == Layout::None) {
+        return;
+    }
+
+    // 保持宽高比居中显示
+    qreal dpr = devicePixelRatioF();
+    QSize viewport(qRound(width() * dpr), qRound(height() * dpr));
+    QSize fitted = QSize(m_frameWidth, m_frameHeight).scaled(viewport, Qt::KeepAspectRatio);
+    glViewport((viewport.width() - fitted.width()) / 2, (viewport.height() - fitted.height()) / 2,
+               fitted.width(), fitted.height());
+
+    m_program.bind();
+    for (int i = 0; i < m_planeCount; i++) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, m_planes[i].texture);
+    }
+    m_program.setUniformValue("u_texY", 0);
+    m_program.setUniformValue("u_texU", 1);
+    m_program.setUniformValue("u_texV", 2);
+    m_program.setUniformValue("u_layout", static_cast<GLint>(m_layout));
+    m_program.setUniformValue("u_colorMatrix", QMatrix3x3(m_colorMatrix));
+    m_program.setUniformValue("u_colorOffset", m_colorOffset[0], m_colorOffset[1], m_colorOffset[2]);
+
+    m_program.enableAttributeArray(0);
+    m_program.enableAttributeArray(1);
+    m_program.setAttributeArray(0, kVertices, 2);
+    m_program.setAttributeArray(1, kTexCoords, 2);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    m_program.disableAttributeArray(0);
+    m_program.disableAttributeArray(1);
+    m_program.release();
+    glActiveTexture(GL_TEXTURE0);
+}
+
+bool GLVideoWidget::initShaders()
+{
+    if (!m_program.addShaderFromSourceCode(QOpenGLShader::Vertex, kVertexShader)
+            || !m_program.addShaderFromSourceCode(QOpenGLShader::Fragment, kFragmentShader)) {
+        qDebug() << "着色器编译失败:" << m_program.log();
+        return false;
+    }
+
+    m_program.bindAttributeLocation("a_position", 0);
+    m_program.bindAttributeLocation("a_texCoord", 1);
+    if (!m_program.link()) {
+        qDebug() << "着色器链接失败:" << m_program.log();
+        return false;
+    }
+    return true;
+}
+
+void GLVideoWidget::releaseGL()
+{
+    if (m_glFailed) {
+        return;
+    }
+
+    for (Plane &plane : m_planes) {
+        if (plane.texture) {
+            glDeleteTextures(1, &plane.texture);
+            plane.texture = 0;
+        }
+    }
+    if (m_usePbo) {
+        glDeleteBuffers(6, &m_pbo[0][0]);
+        memset(m_pbo, 0, sizeof(m_pbo));
+    }
+}
+
+// 帧格式或尺寸变化时重建纹理
+bool GLVideoWidget::setupPlanes(const AVFrame *frame)
+{
+    Layout layout;
+    int chromaWidth = (frame->width + 1) / 2;
+    int chromaHeight = (frame->height + 1) / 2;
+
+    Plane planes[3];
+    int count = 0;
+    switch (frame->format) {
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+        layout = Layout::I420;
+        planes[0].width = frame->width;
+        planes[0].height = frame->height;
+        planes[1].width = planes[2].width = chromaWidth;
+        planes[1].height = planes[2].height = chromaHeight;
+        for (int i = 0; i < 3; i++) {
+            planes[i].format = GL_LUMINANCE;
+            planes[i].bytesPerPixel = 1;
+        }
+        count = 3;
+        break;
+    case AV_PIX_FMT_NV12:
+        layout = Layout::NV12;
+        planes[0].width = frame->width;
+        planes[0].height = frame->height;
+        planes[0].format = GL_LUMINANCE;
+        planes[0].bytesPerPixel = 1;
+        planes[1].width = chromaWidth;
+        planes[1].height = chromaHeight;
+        planes[1].format = GL_LUMINANCE_ALPHA;
+        planes[1].bytesPerPixel = 2;
+        count = 2;
+        break;
+    case AV_PIX_FMT_BGRA:
+    case AV_PIX_FMT_BGR0:
+        layout = Layout::Rgb32;
+        planes[0].width = frame->width;
+        planes[0].height = frame->height;
+        planes[0].format = GL_RGBA;
+        planes[0].bytesPerPixel = 4;
+        count = 1;
+        break;
+    default:
+        return false;
+    }
+
+    if (layout == m_layout && frame->width == m_frameWidth && frame->height == m_frameHeight) {
+        return true;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        GLuint texture = m_planes[i].texture;
+        m_planes[i] = planes[i];
+        m_planes[i].texture = texture;
+        if (i >= count) {
+            continue;
+        }
+        if (!m_planes[i].texture) {
+            glGenTextures(1, &m_planes[i].texture);
+        }
+        glBindTexture(GL_TEXTURE_2D, m_planes[i].texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, m_planes[i].format, m_planes[i].width, m_planes[i].height, 0,
+                     m_planes[i].format, GL_UNSIGNED_BYTE, nullptr);
+    }
+
+    m_layout = layout;
+    m_planeCount = count;
+    m_frameWidth = frame->width;
+    m_frameHeight = frame->height;
+    return true;
+}
+
+void GLVideoWidget::uploadFrame(const AVFrame *frame)
+{
+    if (!frame || !setupPlanes(frame)) {
+        return;
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int i = 0; i < m_planeCount; i++) {
+        uploadPlane(i, frame->data[i], frame->linesize[i]);
+    }
+    m_pboIndex ^= 1;
+
+    updateColorMatrix(frame);
+}
+
+void GLVideoWidget::uploadPlane(int index, const uint8_t *data, int linesize)
+{
+    const Plane &plane = m_planes[index];
+    int rowBytes = plane.width * plane.bytesPerPixel;
+    glBindTexture(GL_TEXTURE_2D, plane.texture);
+
+    if (m_usePbo) {
+        int size = rowBytes * plane.height;
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pbo[m_pboIndex][index]);
+        // 重新指定存储使驱动丢弃旧内容，不必等待 GPU 读完上一次的数据
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        uint8_t *dst = static_cast<uint8_t *>(m_extraFunctions->glMapBufferRange(
+                GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        if (dst) {
+            for (int y = 0; y < plane.height; y++) {
+                memcpy(dst + y * rowBytes, data + y * linesize, rowBytes);
+            }
+            m_extraFunctions->glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, plane.width, plane.height,
+                            plane.format, GL_UNSIGNED_BYTE, nullptr);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            return;
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    if (linesize == rowBytes) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, plane.width, plane.height,
+                        plane.format, GL_UNSIGNED_BYTE, data);
+    } else if (m_hasUnpackRowLength) {
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, linesize / plane.bytesPerPixel);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, plane.width, plane.height,
+                        plane.format, GL_UNSIGNED_BYTE, data);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    } else {
+        // ES 2.0 没有 UNPACK_ROW_LENGTH，去掉行尾填充后上传
+        m_repackBuffer.resize(rowBytes * plane.height);
+        uint8_t *dst = reinterpret_cast<uint8_t *>(m_repackBuffer.data());
+        for (int y = 0; y < plane.height; y++) {
+            memcpy(dst + y * rowBytes, data + y * linesize, rowBytes);
+        }
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, plane.width, plane.height,
+                        plane.format, GL_UNSIGNED_BYTE, dst);
+    }
+}
+
+void GLVideoWidget::updateColorMatrix(const AVFrame *frame)
+{
+    bool bt709 = frame->colorspace == AVCOL_SPC_BT709;
+    bool fullRange = frame->color_range == AVCOL_RANGE_JPEG || frame->format == AV_PIX_FMT_YUVJ420P;
+
+    float kr = bt709 ? 0.2126f : 0.299f;
+    float kb = bt709 ? 0.0722f : 0.114f;
+    float kg = 1.0f - kr - kb;
+    float ys = fullRange ? 1.0f : 255.0f / 219.0f;
+    float cs = fullRange ? 1.0f : 255.0f / 224.0f;
+
+    // 行主序：rgb = M * (yuv - offset)
+    float matrix[9] = {
+        ys, 0.0f,                            2.0f * (1.0f - kr) * cs,
+        ys, -2.0f * kb * (1.0f - kb) / kg * cs, -2.0f * kr * (1.0f - kr) / kg * cs,
+        ys, 2.0f * (1.0f - kb) * cs,         0.0f
+    };
+    memcpy(m_colorMatrix, matrix, sizeof(matrix));
+
+    m_colorOffset[0] = fullRange ? 0.0f : 16.0f / 255.0f;
+    m_colorOffset[1] = 128.0f / 255.0f;
+    m_colorOffset[2] = 128.0f / 255.0f;
+}
@@ -0,0 +1,85 @@
+#ifndef GLVIDEOWIDGET_H
+#define GLVIDEOWIDGET_H
+
+#include <QOpenGLWidget>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QByteArray>
+#include "videoframe.h"
+
+class QOpenGLExtraFunctions;
+
+// OpenGL 视频渲染：Y/U/V（或 NV12）平面直接上传为纹理，在片段着色器中转换颜色
+// 支持 PBO 时双缓冲异步上传；RGB32 帧同样可以显示，便于解码端回退
+// 只使用 GLSL 1.00 / GL 2.0 特性，可在 Mesa llvmpipe 软件渲染下运行
+class GLVideoWidget : public QOpenGLWidget, protected QOpenGLFunctions
+{
+    Q_OBJECT
+
+public:
+    explicit GLVideoWidget(QWidget *parent = nullptr);
+    ~GLVideoWidget();
+
+    // 当前帧格式能否直接上传，不能时解码端应输出 RGB32
+    static bool isSupportedFormat(AVPixelFormat format);
+
+public slots:
+    void presentFrame(const VideoFrame &frame);
+
+signals:
+    // OpenGL 不可用（上下文创建或着色器编译失败），由外层切换到 RGB 渲染
+    void glUnavailable();
+
+protected:
+    void initializeGL() override;
+    void resizeGL(int w, int h) override;
+    void paintGL() override;
+
+private:
+    enum class Layout {
+        None = -1,
+        I420 = 0,
+        NV12 = 1,
+        Rgb32 = 2
+    };
+
+    struct Plane {
+        GLuint texture = 0;
+        int width = 0;
+        int height = 0;
+        GLenum format = 0;
+        int bytesPerPixel = 1;
+    };
+
+    bool initShaders();
+    void releaseGL();
+    bool setupPlanes(const AVFrame *frame);
+    void uploadFrame(const AVFrame *frame);
+    void uploadPlane(int index, const uint8_t *data, int linesize);
+    void updateColorMatrix(const AVFrame *frame);
+
+    QOpenGLShaderProgram m_program;
+    QOpenGLExtraFunctions *m_extraFunctions;
+    bool m_glFailed;
+
+    Plane m_planes[3];
+    int m_planeCount;
+    Layout m_layout;
+    int m_frameWidth;
+    int m_frameHeight;
+
+    // 双缓冲 PBO：本帧写入一组，GPU 仍可读取上一组
+    bool m_usePbo;
+    GLuint m_pbo[2][3];
+    int m_pboIndex;
+    bool m_hasUnpackRowLength;
+    QByteArray m_repackBuffer;
+
+    float m_colorMatrix[9];
+    float m_colorOffset[3];
+
+    VideoFrame m_pendingFrame;
+    bool m_hasPendingFrame;
+};
+
+#endif // GLVIDEOWIDGET_H
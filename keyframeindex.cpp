@@ -0,0 +1,73 @@
+#include "keyframeindex.h"
+#include <iterator>
+
+KeyframeIndex::KeyframeIndex()
+    : m_lastKeyframe(0),
+      m_inRun(false)
+{
+}
+
+void KeyframeIndex::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+    m_inRun = false;
+}
+
+void KeyframeIndex::addPacket(qint64 pts, qint64 pos, bool keyframe)
+{
+    if (!keyframe || pos < 0) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    auto it = m_entries.find(pts);
+    if (it == m_entries.end()) {
+        it = m_entries.insert(pts, Node{pos, false});
+    }
+
+    // 上一个关键帧到这里之间没有跳转，两者之间不会再有别的关键帧
+    if (m_inRun && m_lastKeyframe < pts) {
+        auto last = m_entries.find(m_lastKeyframe);
+        if (last != m_entries.end() && std::next(last) == it) {
+            last->contiguous = true;
+        }
+    }
+
+    m_lastKeyframe = pts;
+    m_inRun = true;
+}
+
+void KeyframeIndex::breakRun()
+{
+    QMutexLocker locker(&m_mutex);
+    m_inRun = false;
+}
+
+bool KeyframeIndex::lookup(qint64 target, Entry *entry) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    // 第一个大于 target 的关键帧的前一个即为候选
+    auto next = m_entries.upperBound(target);
+    if (next == m_entries.begin()) {
+        return false;
+    }
+    auto it = std::prev(next);
+    if (next == m_entries.end() || !it->contiguous) {
+        return false;
+    }
+
+    if (entry) {
+        entry->pts = it.key();
+        entry->pos = it->pos;
+    }
+    return true;
+}
+
+int KeyframeIndex::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_entries.size();
+}
@@ -0,0 +1,44 @@
+#ifndef KEYFRAMEINDEX_H
+#define KEYFRAMEINDEX_H
+
+#include <QMap>
+#include <QMutex>
+
+// 视频关键帧索引：pts（流时间基）-> 文件字节偏移，在解复用过程中逐步建立
+// 只有连续读过的区间才能确定“目标之前最近的关键帧”，跳转会打断连续区间
+class KeyframeIndex
+{
+public:
+    struct Entry {
+        qint64 pts = 0;
+        qint64 pos = -1;
+    };
+
+    KeyframeIndex();
+
+    void clear();
+
+    // 解复用线程每读到一个视频包调用一次，关键帧才会记入索引
+    void addPacket(qint64 pts, qint64 pos, bool keyframe);
+    // 读取位置不连续（跳转）后调用
+    void breakRun();
+
+    // 找到 target 所在 GOP 的关键帧；区间未连续读过时返回 false
+    bool lookup(qint64 target, Entry *entry) const;
+
+    int size() const;
+
+private:
+    struct Node {
+        qint64 pos;
+        // 从该关键帧一直连续读到了下一个关键帧
+        bool contiguous;
+    };
+
+    mutable QMutex m_mutex;
+    QMap<qint64, Node> m_entries;
+    qint64 m_lastKeyframe;
+    bool m_inRun;
+};
+
+#endif // KEYFRAMEINDEX_H
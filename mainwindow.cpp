@@ -3,6 +3,9 @@
 
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QMouseEvent>
+#include <QSignalBlocker>
+#include <QStyle>
 #include <QtConcurrent/QtConcurrentRun>
 
 MainWindow::MainWindow(QWidget *parent)
@@ -16,6 +19,21 @@ MainWindow::MainWindow(QWidget *parent)
     player = new QMediaPlayer(this);
     player->setVideoOutput(ui->videoWidget);
 
+    m_seekCoordinator = new SeekCoordinator(this);
+
+    // 鼠标悬停在进度条上时显示该位置的缩略图
+    m_thumbnails = new ThumbnailService(this);
+    m_thumbnailPopup = new QLabel(this, Qt::ToolTip | Qt::FramelessWindowHint);
+    m_thumbnailPopup->hide();
+    ui->sliderPosition->setMouseTracking(true);
+    ui->sliderPosition->installEventFilter(this);
+
+    // 右键把列表中的视频加入多画面窗口
+    m_videoWall = nullptr;
+    m_videoWallAction = new QAction("在多画面中打开", this);
+    ui->videoListWidget->setContextMenuPolicy(Qt::ActionsContextMenu);
+    ui->videoListWidget->addAction(m_videoWallAction);
+
     // 与服务器建立连接
     connectServer();
     initSlots();
@@ -41,15 +59,113 @@ void MainWindow::initSlots()
        // QCoreApplication::quit();
     });
 
-//    connect(m_playerThread, &VideoPlayer::frameReady,
-//            this, &MainWindow::onFrameReady);
+//    ui->videoWidget->setFrameMailbox(m_playerThread->frameMailbox());
 //    connect(m_playerThread, &VideoPlayer::statusChanged,
 //            this, &MainWindow::onStatusChanged);
 //    connect(m_playerThread, &VideoPlayer::errorOccurred,
 //            this, &MainWindow::onErrorOccurred);
+//    connect(ui->videoWidget, &TMyVideoWidget::viewportSizeChanged,
+//            m_playerThread, &VideoPlayer::setOutputSize);
+//    connect(ui->videoWidget, &TMyVideoWidget::outputFormatChanged,
+//            m_playerThread, &VideoPlayer::setOutputFormat);
+//    ui->videoWidget->setRenderBackend(TMyVideoWidget::RenderBackend::OpenGL);
+//    connect(m_seekCoordinator, &SeekCoordinator::seekRequested, this, [this](qint64 position, bool accurate) {
+//        m_playerThread->seek(position, accurate);
+//    });
+//    connect(m_playerThread, &VideoPlayer::seekFinished,
+//            m_seekCoordinator, &SeekCoordinator::seekCompleted);
+
+    // 拖动时只发送最新的目标，松开后精确跳转一次
+    connect(ui->sliderPosition, &QSlider::sliderPressed, m_seekCoordinator, &SeekCoordinator::beginScrub);
+    connect(ui->sliderPosition, &QSlider::sliderMoved, m_seekCoordinator, &SeekCoordinator::scrubTo);
+    connect(ui->sliderPosition, &QSlider::sliderReleased, this, [this]() {
+        m_seekCoordinator->endScrub(ui->sliderPosition->sliderPosition());
+    });
+    // QMediaPlayer 没有关键帧跳转模式，预览和精确跳转都用 setPosition
+    connect(m_seekCoordinator, &SeekCoordinator::seekRequested, this, [this](qint64 position, bool) {
+        player->setPosition(position);
+    });
     connect(player, &QMediaPlayer::stateChanged, this, &MainWindow::do_stateChanged);
     connect(player, &QMediaPlayer::positionChanged, this, &MainWindow::do_positionChanged);
     connect(player, &QMediaPlayer::durationChanged, this, &MainWindow::do_durationChanged);
+    connect(m_videoWallAction, &QAction::triggered, this, [this]() {
+        openInVideoWall(ui->videoListWidget->currentItem());
+    });
+}
+
+bool MainWindow::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == ui->sliderPosition) {
+        if (event->type() == QEvent::MouseMove) {
+            showThumbnail(static_cast<QMouseEvent *>(event)->pos().x());
+        } else if (event->type() == QEvent::Leave) {
+            m_thumbnailPopup->hide();
+        }
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+void MainWindow::showThumbnail(int x)
+{
+    QSlider *slider = ui->sliderPosition;
+    if (slider->maximum() <= slider->minimum()) {
+        return;
+    }
+
+    // 进度条的值是毫秒
+    int value = QStyle::sliderValueFromPosition(slider->minimum(), slider->maximum(), x, slider->width());
+    QImage image = m_thumbnails->thumbnail(value / 1000.0);
+    if (image.isNull()) {
+        m_thumbnailPopup->hide();
+        return;
+    }
+
+    m_thumbnailPopup->setPixmap(QPixmap::fromImage(image));
+    m_thumbnailPopup->resize(image.size());
+    QPoint pos = slider->mapToGlobal(QPoint(x - image.width() / 2, -image.height() - 4));
+    m_thumbnailPopup->move(pos);
+    m_thumbnailPopup->show();
+}
+
+// clarity 为空时使用当前选择的清晰度
+QString MainWindow::streamUrl(const QString &fileName, const QString &clarity) const
+{
+    QString hlsUrl = "http://172.23.206.96:8081/vod/";  // 基础 URL
+    hlsUrl += QFileInfo(fileName).baseName();  // 文件名
+    // 选项是 "720p", "1080p"
+    hlsUrl += '/' + (clarity.isEmpty() ? ui->clarityComboBox->currentText() : clarity);
+    hlsUrl += "/index.m3u8";
+    return hlsUrl;
+}
+
+// 清晰度列表中分辨率最低的一项
+QString MainWindow::lowestClarity() const
+{
+    QString lowest = ui->clarityComboBox->currentText();
+    for (int i = 0; i < ui->clarityComboBox->count(); i++) {
+        QString text = ui->clarityComboBox->itemText(i);
+        int lines = text.chopped(1).toInt();
+        if (lines > 0 && lines < lowest.chopped(1).toInt()) {
+            lowest = text;
+        }
+    }
+    return lowest;
+}
+
+void MainWindow::openInVideoWall(QListWidgetItem *item)
+{
+    if (!item) return;
+
+    // 多路流共用一个窗口和一组解码线程，代替同时开多个 MainWindow
+    if (!m_videoWall) {
+        m_videoWall = new VideoWallWidget(this);
+        m_videoWall->setWindowFlags(Qt::Window);
+        m_videoWall->setWindowTitle("多画面");
+        m_videoWall->resize(1280, 720);
+    }
+    m_videoWall->addStream(streamUrl(item->text()));
+    m_videoWall->show();
+    m_videoWall->raise();
 }
 
 void MainWindow::uploadFile(QString fileName)
@@ -64,13 +180,10 @@ void MainWindow::updateVideoMess()
 
 }
 
-void MainWindow::onFrameReady(const QImage &frame)
+void MainWindow::onFrameReady(const VideoFrame &frame)
 {
-//    if (!frame.isNull()) {
-//        QPixmap pixmap = QPixmap::fromImage(frame);
-//        ui->videoLabel->setPixmap(pixmap.scaled(ui->videoLabel->size(),
-//                                              Qt::KeepAspectRatio));
-//    }
+//    // YUV 帧由 OpenGL 渲染，RGB 帧由 Raster 渲染
+//    ui->videoWidget->presentFrame(frame);
 }
 
 void MainWindow::onStatusChanged(int status)
@@ -104,9 +217,12 @@ void MainWindow::do_durationChanged(qint64 duration)
 
 void MainWindow::do_positionChanged(qint64 position)
 {//文件播放位置变化
+    m_seekCoordinator->positionReached(position);
     if (ui->sliderPosition->isSliderDown())
         return;  //如果正在拖动滑条，退出
-    ui->sliderPosition->setSliderPosition(position);
+    // 程序设置进度条位置时不发出 valueChanged，避免再次触发跳转
+    QSignalBlocker blocker(ui->sliderPosition);
+    ui->sliderPosition->setValue(position);
 
     int secs = position / 1000;  //秒
     int mins = secs / 60;        //分钟
@@ -168,7 +284,7 @@ void MainWindow::on_btnSound_clicked()
 
 void MainWindow::on_sliderPosition_valueChanged(int value)
 {
-    player->setPosition(value);
+    m_seekCoordinator->requestSeek(value);
 }
 
 void MainWindow::on_videoListWidget_itemDoubleClicked(QListWidgetItem *item)
@@ -184,13 +300,12 @@ void MainWindow::on_videoListWidget_itemDoubleClicked(QListWidgetItem *item)
         player->setMedia(QMediaContent());  // 清空媒体内容
     }
 
-    QString hlsUrl = "http://172.23.206.96:8081/vod/";  // 基础 URL
-    hlsUrl += QFileInfo(selectedText).baseName();  // 文件名
-    QString clarity = ui->clarityComboBox->currentText();  // 选项是 "720p", "1080p"
-    hlsUrl += '/' + clarity;
-    hlsUrl += "/index.m3u8";
+    QString hlsUrl = streamUrl(selectedText);
     qDebug() << "生成的 HLS URL：" << hlsUrl;
 
+    // 缩略图只有 160 像素宽，用最低清晰度的码流，少占播放的带宽
+    m_thumbnails->setSource(streamUrl(selectedText, lowestClarity()));
+
     // m_playerThread->play(hlsUrl);
     player->setMedia(QUrl(hlsUrl));
     //player->setMedia(QUrl::fromLocalFile("D:/video/002.mp4"));
@@ -1,12 +1,17 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include <QAction>
+#include <QLabel>
 #include <QListWidget>
 #include <QMainWindow>
 #include <QtMultimedia>
 #include "fileuploader.h"
 #include "videoplayer.h"
 #include "tmyvideowidget.h"
+#include "thumbnailservice.h"
+#include "seekcoordinator.h"
+#include "videowallwidget.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -27,8 +32,11 @@ public:
     void uploadFile(QString fileName);
     void updateVideoMess();
 
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
 private slots:
-    void onFrameReady(const QImage &frame);
+    void onFrameReady(const VideoFrame &frame);
     void onStatusChanged(int status);
     void onErrorOccurred(const QString &errorMessage);
 
@@ -53,6 +61,11 @@ private slots:
     void on_videoListWidget_itemDoubleClicked(QListWidgetItem *item);
 
 private:
+    void showThumbnail(int x);
+    QString streamUrl(const QString &fileName, const QString &clarity = QString()) const;
+    QString lowestClarity() const;
+    void openInVideoWall(QListWidgetItem *item);
+
     Ui::MainWindow *ui;
     FileUploader uploader;
     VideoPlayer *m_playerThread;
@@ -60,5 +73,16 @@ private:
     QString currentFile;
     QString durationTime;
     QString positionTime;
+
+    // 合并进度条拖动产生的跳转
+    SeekCoordinator *m_seekCoordinator;
+
+    // 进度条悬停预览
+    ThumbnailService *m_thumbnails;
+    QLabel *m_thumbnailPopup;
+
+    // 多画面窗口，第一次使用时创建
+    VideoWallWidget *m_videoWall;
+    QAction *m_videoWallAction;
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,89 @@
+#include "mediaclock.h"
+#include <cmath>
+
+MediaClock::MediaClock()
+    : m_anchorPts(0.0),
+      m_anchorNs(0),
+      m_anchored(false),
+      m_paused(false),
+      m_pausedTime(NAN)
+{
+    m_timer.start();
+}
+
+void MediaClock::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_anchored = false;
+    m_pausedTime = NAN;
+}
+
+void MediaClock::setAudioClockSource(const AudioClockSource &source)
+{
+    QMutexLocker locker(&m_mutex);
+    m_audioSource = source;
+}
+
+bool MediaClock::isAudioMaster() const
+{
+    QMutexLocker locker(&m_mutex);
+    return static_cast<bool>(m_audioSource);
+}
+
+void MediaClock::anchor(double pts)
+{
+    QMutexLocker locker(&m_mutex);
+    m_anchorPts = pts;
+    m_anchorNs = m_timer.nsecsElapsed();
+    m_anchored = true;
+    m_pausedTime = pts;
+}
+
+bool MediaClock::isAnchored() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_anchored;
+}
+
+double MediaClock::time() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    // 音频时钟有效时优先使用
+    if (m_audioSource) {
+        double audioTime = m_audioSource();
+        if (!std::isnan(audioTime)) {
+            return audioTime;
+        }
+    }
+    return systemTimeLocked();
+}
+
+void MediaClock::setPaused(bool paused)
+{
+    QMutexLocker locker(&m_mutex);
+    if (paused == m_paused) {
+        return;
+    }
+
+    if (paused) {
+        // 冻结当前时间
+        m_pausedTime = systemTimeLocked();
+    } else if (m_anchored && !std::isnan(m_pausedTime)) {
+        // 从暂停点继续走
+        m_anchorPts = m_pausedTime;
+        m_anchorNs = m_timer.nsecsElapsed();
+    }
+    m_paused = paused;
+}
+
+double MediaClock::systemTimeLocked() const
+{
+    if (!m_anchored) {
+        return NAN;
+    }
+    if (m_paused) {
+        return m_pausedTime;
+    }
+    return m_anchorPts + (m_timer.nsecsElapsed() - m_anchorNs) / 1e9;
+}
@@ -0,0 +1,43 @@
+#ifndef MEDIACLOCK_H
+#define MEDIACLOCK_H
+
+#include <QMutex>
+#include <QElapsedTimer>
+#include <functional>
+
+// 播放主时钟：接入音频输出时以音频播放位置为准，否则退回系统时钟
+// 所有时间单位为秒，未就绪时返回 NAN
+class MediaClock
+{
+public:
+    typedef std::function<double()> AudioClockSource;
+
+    MediaClock();
+
+    void reset();
+
+    // 音频输出端提供当前正在播放的音频时间，返回 NAN 表示尚未开始
+    void setAudioClockSource(const AudioClockSource &source);
+    bool isAudioMaster() const;
+
+    // 以 pts 重新对齐系统时钟（纯视频首帧、跳转或时间戳跳变）
+    void anchor(double pts);
+    bool isAnchored() const;
+
+    double time() const;
+    void setPaused(bool paused);
+
+private:
+    double systemTimeLocked() const;
+
+    mutable QMutex m_mutex;
+    AudioClockSource m_audioSource;
+    QElapsedTimer m_timer;
+    double m_anchorPts;
+    qint64 m_anchorNs;
+    bool m_anchored;
+    bool m_paused;
+    double m_pausedTime;
+};
+
+#endif // MEDIACLOCK_H
@@ -0,0 +1,184 @@
+#include "packetqueue.h"
+
+PacketQueue::PacketQueue(qint64 maxBytes, double maxDuration)
+    : m_bytes(0),
+      m_duration(0.0),
+      m_maxBytes(maxBytes),
+      m_maxDuration(maxDuration),
+      m_timeBase({1, AV_TIME_BASE}),
+      m_aborted(true),
+      m_interrupted(false)
+{
+}
+
+PacketQueue::~PacketQueue()
+{
+    flush();
+}
+
+void PacketQueue::setLimits(qint64 maxBytes, double maxDuration)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxBytes = maxBytes;
+    m_maxDuration = maxDuration;
+    m_notFull.wakeAll();
+}
+
+void PacketQueue::setTimeBase(AVRational timeBase)
+{
+    QMutexLocker locker(&m_mutex);
+    m_timeBase = timeBase;
+}
+
+bool PacketQueue::put(AVPacket *packet)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // 队列满时等待解码线程消费
+    while (!m_aborted && !m_interrupted && isFullLocked()) {
+        m_notFull.wait(&m_mutex);
+    }
+
+    if (m_aborted || m_interrupted) {
+        av_packet_unref(packet);
+        return false;
+    }
+
+    AVPacket *queued = av_packet_alloc();
+    if (!queued) {
+        av_packet_unref(packet);
+        return false;
+    }
+    av_packet_move_ref(queued, packet);
+
+    m_packets.enqueue(queued);
+    m_bytes += queued->size;
+    m_duration += packetDuration(queued);
+    m_notEmpty.wakeOne();
+    return true;
+}
+
+bool PacketQueue::putNullPacket(int streamIndex)
+{
+    AVPacket *packet = av_packet_alloc();
+    if (!packet) {
+        return false;
+    }
+    packet->data = nullptr;
+    packet->size = 0;
+    packet->stream_index = streamIndex;
+
+    bool ret = put(packet);
+    av_packet_free(&packet);
+    return ret;
+}
+
+int PacketQueue::get(AVPacket *packet, bool block)
+{
+    QMutexLocker locker(&m_mutex);
+
+    while (true) {
+        if (m_aborted) {
+            return -1;
+        }
+
+        if (!m_packets.isEmpty()) {
+            AVPacket *queued = m_packets.dequeue();
+            m_bytes -= queued->size;
+            m_duration -= packetDuration(queued);
+            if (m_packets.isEmpty()) {
+                m_duration = 0.0;
+            }
+
+            av_packet_move_ref(packet, queued);
+            av_packet_free(&queued);
+            m_notFull.wakeOne();
+            return 1;
+        }
+
+        if (!block) {
+            return 0;
+        }
+        m_notEmpty.wait(&m_mutex);
+    }
+}
+
+void PacketQueue::flush()
+{
+    QMutexLocker locker(&m_mutex);
+
+    while (!m_packets.isEmpty()) {
+        AVPacket *queued = m_packets.dequeue();
+        av_packet_free(&queued);
+    }
+    m_bytes = 0;
+    m_duration = 0.0;
+    m_notFull.wakeAll();
+}
+
+void PacketQueue::abort()
+{
+    QMutexLocker locker(&m_mutex);
+    m_aborted = true;
+    m_notEmpty.wakeAll();
+    m_notFull.wakeAll();
+}
+
+void PacketQueue::start()
+{
+    QMutexLocker locker(&m_mutex);
+    m_aborted = false;
+}
+
+void PacketQueue::interrupt()
+{
+    QMutexLocker locker(&m_mutex);
+    m_interrupted = true;
+    m_notFull.wakeAll();
+}
+
+void PacketQueue::clearInterrupt()
+{
+    QMutexLocker locker(&m_mutex);
+    m_interrupted = false;
+}
+
+PacketQueue::Stats PacketQueue::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    Stats stats;
+    stats.packets = m_packets.size();
+    stats.bytes = m_bytes;
+    stats.duration = m_duration;
+    return stats;
+}
+
+bool PacketQueue::isFull() const
+{
+    QMutexLocker locker(&m_mutex);
+    return isFullLocked();
+}
+
+bool PacketQueue::isAborted() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_aborted;
+}
+
+bool PacketQueue::isFullLocked() const
+{
+    // 至少保留一个包，避免单个超大包把写入方永久阻塞
+    if (m_packets.isEmpty()) {
+        return false;
+    }
+    return m_bytes >= m_maxBytes || m_duration >= m_maxDuration;
+}
+
+double PacketQueue::packetDuration(const AVPacket *packet) const
+{
+    if (packet->duration <= 0) {
+        return 0.0;
+    }
+    return packet->duration * av_q2d(m_timeBase);
+}
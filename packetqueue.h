@@ -0,0 +1,67 @@
+#ifndef PACKETQUEUE_H
+#define PACKETQUEUE_H
+
+#include <QQueue>
+#include <QMutex>
+#include <QWaitCondition>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+// 有界的 AVPacket 队列，解复用线程写入，解码线程读取
+// 同时按字节数和时长限制队列深度，满时阻塞写入方
+class PacketQueue
+{
+public:
+    struct Stats {
+        int packets = 0;
+        qint64 bytes = 0;
+        double duration = 0.0;   // 秒
+    };
+
+    PacketQueue(qint64 maxBytes, double maxDuration);
+    ~PacketQueue();
+
+    // 队列限制
+    void setLimits(qint64 maxBytes, double maxDuration);
+    void setTimeBase(AVRational timeBase);
+
+    // 写入数据包（转移引用），队列满时阻塞，被中止或中断时返回 false
+    bool put(AVPacket *packet);
+    // 写入空包，通知解码器冲刷剩余帧
+    bool putNullPacket(int streamIndex);
+    // 读取数据包，返回 1 成功，0 无数据（非阻塞），-1 已中止
+    int get(AVPacket *packet, bool block);
+
+    void flush();
+    void abort();
+    void start();
+    // 中断阻塞的写入方，之后的写入立即失败，直到 clearInterrupt；读取不受影响
+    void interrupt();
+    void clearInterrupt();
+
+    Stats stats() const;
+    bool isFull() const;
+    bool isAborted() const;
+
+private:
+    bool isFullLocked() const;
+    double packetDuration(const AVPacket *packet) const;
+
+    QQueue<AVPacket *> m_packets;
+    qint64 m_bytes;
+    double m_duration;
+
+    qint64 m_maxBytes;
+    double m_maxDuration;
+    AVRational m_timeBase;
+    bool m_aborted;
+    bool m_interrupted;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_notEmpty;
+    QWaitCondition m_notFull;
+};
+
+#endif // PACKETQUEUE_H
@@ -0,0 +1,168 @@
+#include "probecache.h"
+#include <QDateTime>
+#include <QFileInfo>
+
+ProbeCache::Entry::~Entry()
+{
+    for (Stream &stream : streams) {
+        avcodec_parameters_free(&stream.codecpar);
+    }
+}
+
+ProbeCache::ProbeCache(int capacity)
+    : m_capacity(qMax(1, capacity)),
+      m_hits(0),
+      m_misses(0)
+{
+}
+
+ProbeCache &ProbeCache::instance()
+{
+    static ProbeCache cache;
+    return cache;
+}
+
+QString ProbeCache::cacheKey(const QString &url)
+{
+    QFileInfo info(url);
+    if (info.isFile()) {
+        return QString("%1|%2|%3").arg(url).arg(info.size()).arg(info.lastModified().toMSecsSinceEpoch());
+    }
+    return url;
+}
+
+QSharedPointer<const ProbeCache::Entry> ProbeCache::find(const QString &url)
+{
+    QString key = cacheKey(url);
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < m_entries.size(); i++) {
+        if (m_entries.at(i).key == key) {
+            if (i != 0) {
+                m_entries.move(i, 0);
+            }
+            m_hits++;
+            return m_entries.first().entry;
+        }
+    }
+    m_misses++;
+    return QSharedPointer<const Entry>();
+}
+
+void ProbeCache::store(const QString &url, const AVFormatContext *context, int videoStreamIndex, int audioStreamIndex)
+{
+    QSharedPointer<Entry> entry(new Entry);
+    entry->videoStreamIndex = videoStreamIndex;
+    entry->audioStreamIndex = audioStreamIndex;
+    entry->duration = context->duration;
+    entry->startTime = context->start_time;
+
+    for (unsigned int i = 0; i < context->nb_streams; i++) {
+        const AVStream *avStream = context->streams[i];
+        Stream stream;
+        stream.codecpar = avcodec_parameters_alloc();
+        if (!stream.codecpar || avcodec_parameters_copy(stream.codecpar, avStream->codecpar) < 0) {
+            avcodec_parameters_free(&stream.codecpar);
+            return;
+        }
+        stream.avgFrameRate = avStream->avg_frame_rate;
+        stream.rFrameRate = avStream->r_frame_rate;
+        entry->streams.append(stream);
+    }
+
+    QString key = cacheKey(url);
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < m_entries.size(); i++) {
+        if (m_entries.at(i).key == key) {
+            m_entries.removeAt(i);
+            break;
+        }
+    }
+    // 淘汰最久未使用的结果，仍被播放端引用的条目在引用释放后析构
+    while (m_entries.size() >= m_capacity) {
+        m_entries.removeLast();
+    }
+    Item item;
+    item.key = key;
+    item.entry = entry;
+    m_entries.prepend(item);
+}
+
+void ProbeCache::remove(const QString &url)
+{
+    QString key = cacheKey(url);
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < m_entries.size(); i++) {
+        if (m_entries.at(i).key == key) {
+            m_entries.removeAt(i);
+            return;
+        }
+    }
+}
+
+void ProbeCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+}
+
+bool ProbeCache::apply(const Entry &entry, AVFormatContext *context)
+{
+    // 流的数量和类型必须一致，解复用器已经识别出的编码也必须一致
+    if (static_cast<int>(context->nb_streams) != entry.streams.size()) {
+        return false;
+    }
+    for (unsigned int i = 0; i < context->nb_streams; i++) {
+        const AVCodecParameters *opened = context->streams[i]->codecpar;
+        const AVCodecParameters *cached = entry.streams.at(i).codecpar;
+        if (opened->codec_type != AVMEDIA_TYPE_UNKNOWN && opened->codec_type != cached->codec_type) {
+            return false;
+        }
+        if (opened->codec_id != AV_CODEC_ID_NONE && opened->codec_id != cached->codec_id) {
+            return false;
+        }
+    }
+
+    for (unsigned int i = 0; i < context->nb_streams; i++) {
+        AVStream *stream = context->streams[i];
+        const Stream &cached = entry.streams.at(i);
+        if (avcodec_parameters_copy(stream->codecpar, cached.codecpar) < 0) {
+            return false;
+        }
+        stream->avg_frame_rate = cached.avgFrameRate;
+        stream->r_frame_rate = cached.rFrameRate;
+    }
+    if (context->duration == AV_NOPTS_VALUE) {
+        context->duration = entry.duration;
+    }
+    if (context->start_time == AV_NOPTS_VALUE) {
+        context->start_time = entry.startTime;
+    }
+    return true;
+}
+
+void ProbeCache::setCapacity(int capacity)
+{
+    QMutexLocker locker(&m_mutex);
+    m_capacity = qMax(1, capacity);
+    while (m_entries.size() > m_capacity) {
+        m_entries.removeLast();
+    }
+}
+
+int ProbeCache::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_entries.size();
+}
+
+qint64 ProbeCache::hits() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_hits;
+}
+
+qint64 ProbeCache::misses() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_misses;
+}
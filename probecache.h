@@ -0,0 +1,70 @@
+#ifndef PROBECACHE_H
+#define PROBECACHE_H
+
+#include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+// 按 URL 缓存 avformat_find_stream_info 的结果：各流的编码参数（含 extradata）、帧率和选中的流
+// 同一 URL 再次打开时直接写回 AVFormatContext，跳过探测；进程内共享，超出容量时淘汰最久未使用的
+class ProbeCache
+{
+public:
+    struct Stream {
+        AVCodecParameters *codecpar = nullptr;
+        AVRational avgFrameRate = { 0, 1 };
+        AVRational rFrameRate = { 0, 1 };
+    };
+
+    struct Entry {
+        QVector<Stream> streams;
+        int videoStreamIndex = -1;
+        int audioStreamIndex = -1;
+        int64_t duration = AV_NOPTS_VALUE;
+        int64_t startTime = AV_NOPTS_VALUE;
+
+        ~Entry();
+    };
+
+    static ProbeCache &instance();
+
+    // 本地文件的键包含大小和修改时间
+    static QString cacheKey(const QString &url);
+
+    QSharedPointer<const Entry> find(const QString &url);
+    // 从已完成探测的上下文保存
+    void store(const QString &url, const AVFormatContext *context, int videoStreamIndex, int audioStreamIndex);
+    void remove(const QString &url);
+    void clear();
+
+    // 打开后（未探测）的流布局与缓存一致时写回编码参数并返回 true
+    static bool apply(const Entry &entry, AVFormatContext *context);
+
+    void setCapacity(int capacity);
+    int size() const;
+    qint64 hits() const;
+    qint64 misses() const;
+
+private:
+    explicit ProbeCache(int capacity = 64);
+
+    struct Item {
+        QString key;
+        QSharedPointer<const Entry> entry;
+    };
+
+    // 最近使用的在前
+    QList<Item> m_entries;
+    int m_capacity;
+    qint64 m_hits;
+    qint64 m_misses;
+    mutable QMutex m_mutex;
+};
+
+#endif // PROBECACHE_H
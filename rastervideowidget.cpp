@@ -0,0 +1,73 @@
+#include "rastervideowidget.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QPainter>
+#include <QPaintEvent>
+
+// 每隔多少帧输出一次绘制耗时
+static const qint64 kPaintLogInterval = 300;
+
+RasterVideoWidget::RasterVideoWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void RasterVideoWidget::presentFrame(const VideoFrame &frame)
+{
+    if (frame.isNull() || VideoFrame::imageFormat(frame.format()) == QImage::Format_Invalid) {
+        return;
+    }
+
+    m_frame = frame;
+    update();
+}
+
+void RasterVideoWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::black);
+
+    QImage image = m_frame.toImage();
+    if (image.isNull()) {
+        return;
+    }
+
+    // 只计 drawImage：非 32 位格式的转换就发生在这里
+    QElapsedTimer paintTimer;
+    paintTimer.start();
+
+    // 保持宽高比居中显示
+    QSize fitted = image.size().scaled(size(), Qt::KeepAspectRatio);
+    QRect target(QPoint((width() - fitted.width()) / 2, (height() - fitted.height()) / 2), fitted);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.drawImage(target, image);
+
+    recordPaintTime(image.format(), paintTimer.nsecsElapsed() / 1e6);
+}
+
+RasterVideoWidget::PaintStats RasterVideoWidget::paintStats() const
+{
+    return m_paintStats;
+}
+
+void RasterVideoWidget::recordPaintTime(QImage::Format format, double ms)
+{
+    if (format != m_paintStats.format) {
+        m_paintStats = PaintStats();
+        m_paintStats.format = format;
+    }
+
+    m_paintStats.frames++;
+    m_paintStats.lastPaintTime = ms;
+    m_paintStats.maxPaintTime = qMax(m_paintStats.maxPaintTime, ms);
+    // 指数滑动平均，近 32 帧
+    m_paintStats.avgPaintTime += (ms - m_paintStats.avgPaintTime) / qMin<qint64>(m_paintStats.frames, 32);
+
+    if (m_paintStats.frames % kPaintLogInterval == 0) {
+        qDebug() << "Raster 绘制耗时: 格式" << format << "平均" << m_paintStats.avgPaintTime
+                 << "ms 最大" << m_paintStats.maxPaintTime << "ms" << size();
+    }
+}
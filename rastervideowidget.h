@@ -0,0 +1,39 @@
+#ifndef RASTERVIDEOWIDGET_H
+#define RASTERVIDEOWIDGET_H
+
+#include <QWidget>
+#include "videoframe.h"
+
+// 软件渲染：直接用 QPainter 绘制 RGB 帧，OpenGL 不可用时使用
+class RasterVideoWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    // GUI 线程绘制耗时（毫秒），按帧的 QImage 格式统计，格式变化时重新计数
+    struct PaintStats {
+        QImage::Format format = QImage::Format_Invalid;
+        qint64 frames = 0;
+        double lastPaintTime = 0.0;
+        double avgPaintTime = 0.0;
+        double maxPaintTime = 0.0;
+    };
+
+    explicit RasterVideoWidget(QWidget *parent = nullptr);
+
+    PaintStats paintStats() const;
+
+public slots:
+    void presentFrame(const VideoFrame &frame);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    void recordPaintTime(QImage::Format format, double ms);
+
+    VideoFrame m_frame;
+    PaintStats m_paintStats;
+};
+
+#endif // RASTERVIDEOWIDGET_H
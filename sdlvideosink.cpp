@@ -0,0 +1,285 @@
+#include "sdlvideosink.h"
+#include <QDebug>
+#include <QMutexLocker>
+
+#define SDL_MAIN_HANDLED
+#include <SDL.h>
+
+SdlVideoSink::SdlVideoSink()
+    : m_window(nullptr),
+      m_renderer(nullptr),
+      m_texture(nullptr),
+      m_surface(nullptr),
+      m_videoInitialized(false),
+      m_textureFormat(SDL_PIXELFORMAT_UNKNOWN),
+      m_textureWidth(0),
+      m_textureHeight(0),
+      m_conversionMode(SDL_YUV_CONVERSION_BT601),
+      m_lastPresentNs(-1)
+{
+}
+
+SdlVideoSink::~SdlVideoSink()
+{
+    close();
+}
+
+bool SdlVideoSink::open(WId windowHandle, Renderer renderer, bool vsync)
+{
+    close();
+
+    if (!initVideo()) {
+        return false;
+    }
+
+    m_window = SDL_CreateWindowFrom(reinterpret_cast<const void *>(windowHandle));
+    if (!m_window) {
+        m_errorString = QString("无法绑定窗口: %1").arg(SDL_GetError());
+        close();
+        return false;
+    }
+
+    Uint32 flags = vsync ? SDL_RENDERER_PRESENTVSYNC : 0;
+    SDL_Renderer *sdlRenderer = nullptr;
+    if (renderer == Renderer::Accelerated) {
+        sdlRenderer = SDL_CreateRenderer(m_window, -1, flags | SDL_RENDERER_ACCELERATED);
+        if (!sdlRenderer) {
+            qDebug() << "硬件渲染器不可用，使用软件渲染:" << SDL_GetError();
+        }
+    }
+    if (!sdlRenderer) {
+        sdlRenderer = SDL_CreateRenderer(m_window, -1, flags | SDL_RENDERER_SOFTWARE);
+    }
+    return createRenderer(sdlRenderer);
+}
+
+bool SdlVideoSink::openOffscreen(int width, int height)
+{
+    close();
+
+    // 软件渲染器直接绘制到 Surface，不需要初始化视频子系统
+    m_surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGB888);
+    if (!m_surface) {
+        m_errorString = QString("无法创建 Surface: %1").arg(SDL_GetError());
+        return false;
+    }
+    return createRenderer(SDL_CreateSoftwareRenderer(m_surface));
+}
+
+void SdlVideoSink::close()
+{
+    if (m_texture) {
+        SDL_DestroyTexture(m_texture);
+        m_texture = nullptr;
+    }
+    if (m_renderer) {
+        SDL_DestroyRenderer(m_renderer);
+        m_renderer = nullptr;
+    }
+    if (m_window) {
+        // 外部窗口只解除绑定，不会被销毁
+        SDL_DestroyWindow(m_window);
+        m_window = nullptr;
+    }
+    if (m_surface) {
+        SDL_FreeSurface(m_surface);
+        m_surface = nullptr;
+    }
+    if (m_videoInitialized) {
+        SDL_QuitSubSystem(SDL_INIT_VIDEO);
+        m_videoInitialized = false;
+    }
+
+    m_textureFormat = SDL_PIXELFORMAT_UNKNOWN;
+    m_textureWidth = 0;
+    m_textureHeight = 0;
+    resetPresentStats();
+}
+
+bool SdlVideoSink::isOpen() const
+{
+    return m_renderer != nullptr;
+}
+
+bool SdlVideoSink::isSupportedFormat(AVPixelFormat format)
+{
+    switch (format) {
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+    case AV_PIX_FMT_NV12:
+    case AV_PIX_FMT_BGRA:
+    case AV_PIX_FMT_BGR0:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool SdlVideoSink::present(const VideoFrame &frame)
+{
+    if (!m_renderer || frame.isNull() || !isSupportedFormat(frame.format())) {
+        return false;
+    }
+
+    if (!updateTexture(frame.avFrame())) {
+        return false;
+    }
+
+    SDL_SetRenderDrawColor(m_renderer, 0, 0, 0, 255);
+    SDL_RenderClear(m_renderer);
+    SDL_RenderCopy(m_renderer, m_texture, nullptr, nullptr);
+    // 开启 vsync 时在此等待垂直同步
+    SDL_RenderPresent(m_renderer);
+
+    recordPresent();
+    return true;
+}
+
+SdlVideoSink::PresentStats SdlVideoSink::presentStats() const
+{
+    QMutexLocker locker(&m_statsMutex);
+    return m_presentStats;
+}
+
+void SdlVideoSink::resetPresentStats()
+{
+    QMutexLocker locker(&m_statsMutex);
+    m_presentStats = PresentStats();
+    m_lastPresentNs = -1;
+}
+
+QString SdlVideoSink::rendererName() const
+{
+    SDL_RendererInfo info;
+    if (!m_renderer || SDL_GetRendererInfo(m_renderer, &info) != 0) {
+        return QString();
+    }
+    return QString::fromUtf8(info.name);
+}
+
+QString SdlVideoSink::errorString() const
+{
+    return m_errorString;
+}
+
+QImage SdlVideoSink::offscreenImage() const
+{
+    if (!m_surface) {
+        return QImage();
+    }
+    // SDL_PIXELFORMAT_RGB888 即 XRGB8888，与 QImage::Format_RGB32 内存布局相同
+    return QImage(static_cast<const uchar *>(m_surface->pixels), m_surface->w, m_surface->h,
+                  m_surface->pitch, QImage::Format_RGB32);
+}
+
+bool SdlVideoSink::initVideo()
+{
+    SDL_SetMainReady();
+    if (SDL_InitSubSystem(SDL_INIT_VIDEO) != 0) {
+        m_errorString = QString("SDL 视频子系统初始化失败: %1").arg(SDL_GetError());
+        return false;
+    }
+    m_videoInitialized = true;
+    return true;
+}
+
+bool SdlVideoSink::createRenderer(SDL_Renderer *renderer)
+{
+    if (!renderer) {
+        m_errorString = QString("无法创建渲染器: %1").arg(SDL_GetError());
+        close();
+        return false;
+    }
+
+    m_renderer = renderer;
+    m_presentTimer.start();
+    qDebug() << "SDL 渲染器:" << rendererName();
+    return true;
+}
+
+bool SdlVideoSink::updateTexture(const AVFrame *frame)
+{
+    Uint32 format;
+    switch (frame->format) {
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+        format = SDL_PIXELFORMAT_IYUV;
+        break;
+    case AV_PIX_FMT_NV12:
+        format = SDL_PIXELFORMAT_NV12;
+        break;
+    case AV_PIX_FMT_BGRA:
+        format = SDL_PIXELFORMAT_ARGB8888;
+        break;
+    default:
+        format = SDL_PIXELFORMAT_RGB888;
+        break;
+    }
+
+    // SDL2 没有全范围 BT.709，全范围一律按 JPEG（BT.601）处理
+    int mode = SDL_YUV_CONVERSION_BT601;
+    if (frame->color_range == AVCOL_RANGE_JPEG || frame->format == AV_PIX_FMT_YUVJ420P) {
+        mode = SDL_YUV_CONVERSION_JPEG;
+    } else if (frame->colorspace == AVCOL_SPC_BT709) {
+        mode = SDL_YUV_CONVERSION_BT709;
+    }
+
+    // 部分渲染器在创建纹理时确定转换矩阵，参数变化时重建纹理
+    if (!m_texture || format != m_textureFormat || frame->width != m_textureWidth
+            || frame->height != m_textureHeight || mode != m_conversionMode) {
+        if (m_texture) {
+            SDL_DestroyTexture(m_texture);
+        }
+        SDL_SetYUVConversionMode(static_cast<SDL_YUV_CONVERSION_MODE>(mode));
+        m_texture = SDL_CreateTexture(m_renderer, format, SDL_TEXTUREACCESS_STREAMING,
+                                      frame->width, frame->height);
+        if (!m_texture) {
+            m_errorString = QString("无法创建纹理: %1").arg(SDL_GetError());
+            m_textureFormat = SDL_PIXELFORMAT_UNKNOWN;
+            return false;
+        }
+        m_textureFormat = format;
+        m_textureWidth = frame->width;
+        m_textureHeight = frame->height;
+        m_conversionMode = mode;
+
+        // 逻辑尺寸等于帧尺寸，SDL 负责按宽高比居中
+        SDL_RenderSetLogicalSize(m_renderer, frame->width, frame->height);
+    }
+
+    int ret;
+    if (format == SDL_PIXELFORMAT_IYUV) {
+        ret = SDL_UpdateYUVTexture(m_texture, nullptr,
+                                   frame->data[0], frame->linesize[0],
+                                   frame->data[1], frame->linesize[1],
+                                   frame->data[2], frame->linesize[2]);
+    } else if (format == SDL_PIXELFORMAT_NV12) {
+        ret = SDL_UpdateNVTexture(m_texture, nullptr,
+                                  frame->data[0], frame->linesize[0],
+                                  frame->data[1], frame->linesize[1]);
+    } else {
+        ret = SDL_UpdateTexture(m_texture, nullptr, frame->data[0], frame->linesize[0]);
+    }
+
+    if (ret != 0) {
+        m_errorString = QString("纹理更新失败: %1").arg(SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
+void SdlVideoSink::recordPresent()
+{
+    qint64 now = m_presentTimer.nsecsElapsed();
+
+    QMutexLocker locker(&m_statsMutex);
+    m_presentStats.presentedFrames++;
+    if (m_lastPresentNs >= 0) {
+        double interval = (now - m_lastPresentNs) / 1e6;
+        m_presentStats.lastInterval = interval;
+        m_presentStats.avgInterval += (interval - m_presentStats.avgInterval)
+                / qMin<qint64>(m_presentStats.presentedFrames - 1, 32);
+        m_presentStats.maxInterval = qMax(m_presentStats.maxInterval, interval);
+    }
+    m_lastPresentNs = now;
+}
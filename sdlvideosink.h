@@ -0,0 +1,83 @@
+#ifndef SDLVIDEOSINK_H
+#define SDLVIDEOSINK_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+#include <QWindow>
+#include "videoframe.h"
+
+struct SDL_Window;
+struct SDL_Renderer;
+struct SDL_Texture;
+struct SDL_Surface;
+
+// SDL_Renderer 视频输出：YUV 平面直接更新到 SDL 纹理，由渲染器完成颜色转换和缩放
+// 可以绑定到已有的原生窗口，也可以渲染到内存 Surface（软件渲染，无需显示设备）
+// 必须在创建它的线程中调用 present
+class SdlVideoSink
+{
+public:
+    enum class Renderer {
+        Accelerated,    // D3D/OpenGL 等硬件渲染器
+        Software        // SDL 软件渲染器
+    };
+
+    // 两次 present 之间的间隔（毫秒）
+    struct PresentStats {
+        qint64 presentedFrames = 0;
+        double lastInterval = 0.0;
+        double avgInterval = 0.0;
+        double maxInterval = 0.0;
+    };
+
+    SdlVideoSink();
+    ~SdlVideoSink();
+
+    // 绑定原生窗口句柄，vsync 为 true 时 present 与垂直同步对齐
+    bool open(WId windowHandle, Renderer renderer = Renderer::Accelerated, bool vsync = true);
+    // 渲染到 width x height 的内存 Surface，用于无显示环境
+    bool openOffscreen(int width, int height);
+    void close();
+    bool isOpen() const;
+
+    static bool isSupportedFormat(AVPixelFormat format);
+
+    // 上传帧并立即呈现，帧按宽高比居中显示
+    bool present(const VideoFrame &frame);
+
+    PresentStats presentStats() const;
+    void resetPresentStats();
+    QString rendererName() const;
+    QString errorString() const;
+
+    // 离屏模式下的渲染结果（引用内部 Surface，下次 present 前有效）
+    QImage offscreenImage() const;
+
+private:
+    bool initVideo();
+    bool createRenderer(SDL_Renderer *renderer);
+    bool updateTexture(const AVFrame *frame);
+    void recordPresent();
+
+    SDL_Window *m_window;
+    SDL_Renderer *m_renderer;
+    SDL_Texture *m_texture;
+    SDL_Surface *m_surface;
+    bool m_videoInitialized;
+
+    // 当前纹理参数，变化时重建纹理
+    quint32 m_textureFormat;
+    int m_textureWidth;
+    int m_textureHeight;
+    int m_conversionMode;
+
+    QString m_errorString;
+
+    QElapsedTimer m_presentTimer;
+    qint64 m_lastPresentNs;
+    PresentStats m_presentStats;
+    mutable QMutex m_statsMutex;
+};
+
+#endif // SDLVIDEOSINK_H
@@ -0,0 +1,43 @@
+#include "sdlvideowidget.h"
+#include <QDebug>
+
+SdlVideoWidget::SdlVideoWidget(QWidget *parent)
+    : QWidget(parent),
+      m_sdlFailed(false)
+{
+    setAttribute(Qt::WA_NativeWindow);
+    setAttribute(Qt::WA_PaintOnScreen);
+    setAttribute(Qt::WA_NoSystemBackground);
+}
+
+SdlVideoSink::PresentStats SdlVideoWidget::presentStats() const
+{
+    return m_sink.presentStats();
+}
+
+void SdlVideoWidget::presentFrame(const VideoFrame &frame)
+{
+    if (m_sdlFailed) {
+        return;
+    }
+
+    // 第一帧到达时窗口句柄已经有效，再绑定渲染器
+    if (!m_sink.isOpen() && !m_sink.open(winId())) {
+        qDebug() << m_sink.errorString();
+        m_sdlFailed = true;
+        emit sdlUnavailable();
+        return;
+    }
+
+    m_sink.present(frame);
+}
+
+QPaintEngine *SdlVideoWidget::paintEngine() const
+{
+    return nullptr;
+}
+
+void SdlVideoWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+}
@@ -0,0 +1,33 @@
+#ifndef SDLVIDEOWIDGET_H
+#define SDLVIDEOWIDGET_H
+
+#include <QWidget>
+#include "sdlvideosink.h"
+
+// 原生子窗口，由 SdlVideoSink 直接绘制，Qt 不参与绘制
+class SdlVideoWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SdlVideoWidget(QWidget *parent = nullptr);
+
+    SdlVideoSink::PresentStats presentStats() const;
+
+public slots:
+    void presentFrame(const VideoFrame &frame);
+
+signals:
+    // 渲染器创建失败，由外层切换到其他渲染方式
+    void sdlUnavailable();
+
+protected:
+    QPaintEngine *paintEngine() const override;
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    SdlVideoSink m_sink;
+    bool m_sdlFailed;
+};
+
+#endif // SDLVIDEOWIDGET_H
@@ -0,0 +1,146 @@
+#include "seekcoordinator.h"
+#include <QDebug>
+
+SeekCoordinator::SeekCoordinator(QObject *parent)
+    : QObject(parent),
+      m_scrubbing(false),
+      m_inFlight(false),
+      m_inFlightTarget(-1),
+      m_inFlightAccurate(false),
+      m_hasPending(false),
+      m_pendingTarget(-1),
+      m_pendingAccurate(false),
+      m_settling(false)
+{
+    m_timeoutTimer.setSingleShot(true);
+    m_timeoutTimer.setInterval(500);
+    connect(&m_timeoutTimer, &QTimer::timeout, this, &SeekCoordinator::onSeekTimeout);
+}
+
+bool SeekCoordinator::isScrubbing() const
+{
+    return m_scrubbing;
+}
+
+SeekCoordinator::Stats SeekCoordinator::getStats() const
+{
+    return m_stats;
+}
+
+void SeekCoordinator::setSeekTimeout(int ms)
+{
+    m_timeoutTimer.setInterval(ms);
+}
+
+void SeekCoordinator::beginScrub()
+{
+    m_scrubbing = true;
+    m_settling = false;
+    m_stats.drags++;
+    m_stats.lastDragMoves = 0;
+    m_stats.lastDragSeeks = 0;
+}
+
+void SeekCoordinator::scrubTo(qint64 position)
+{
+    if (!m_scrubbing) {
+        return;
+    }
+    m_stats.lastDragMoves++;
+    submit(position, false);
+}
+
+void SeekCoordinator::endScrub(qint64 position)
+{
+    if (!m_scrubbing) {
+        return;
+    }
+    m_scrubbing = false;
+
+    // 松开时的精确跳转替换掉还没发出的预览
+    m_settling = true;
+    m_settleTimer.start();
+    submit(position, true);
+}
+
+void SeekCoordinator::requestSeek(qint64 position)
+{
+    // 拖动中的位置变化由 scrubTo/endScrub 处理
+    if (m_scrubbing) {
+        return;
+    }
+    // 松开进度条时 sliderReleased 之后还会有一次 valueChanged，目标相同则忽略
+    bool duplicate = m_hasPending ? (m_pendingAccurate && m_pendingTarget == position)
+                                  : (m_inFlight && m_inFlightAccurate && m_inFlightTarget == position);
+    if (duplicate) {
+        return;
+    }
+    m_settling = true;
+    m_settleTimer.start();
+    submit(position, true);
+}
+
+void SeekCoordinator::seekCompleted()
+{
+    if (!m_inFlight) {
+        return;
+    }
+    m_timeoutTimer.stop();
+    m_inFlight = false;
+
+    if (m_settling && m_inFlightAccurate && !m_hasPending) {
+        m_settling = false;
+        m_stats.lastSettleTime = m_settleTimer.nsecsElapsed() / 1e6;
+        qDebug() << "跳转稳定:" << m_inFlightTarget << "ms 用时" << m_stats.lastSettleTime
+                 << "ms 拖动" << m_stats.lastDragMoves << "次 实际跳转" << m_stats.lastDragSeeks << "次";
+        emit seekSettled(m_inFlightTarget, m_stats.lastSettleTime);
+    }
+
+    dispatchPending();
+}
+
+void SeekCoordinator::positionReached(qint64 position)
+{
+    if (m_inFlight && qAbs(position - m_inFlightTarget) <= SettleTolerance) {
+        seekCompleted();
+    }
+}
+
+void SeekCoordinator::submit(qint64 position, bool accurate)
+{
+    // 只保留最新的目标
+    m_pendingTarget = position;
+    m_pendingAccurate = accurate;
+    m_hasPending = true;
+
+    if (!m_inFlight) {
+        dispatchPending();
+    }
+}
+
+void SeekCoordinator::dispatchPending()
+{
+    if (!m_hasPending) {
+        return;
+    }
+    // 与正在显示的预览相同的目标只需要补一次精确跳转
+    if (!m_pendingAccurate && m_pendingTarget == m_inFlightTarget) {
+        m_hasPending = false;
+        return;
+    }
+
+    m_hasPending = false;
+    m_inFlight = true;
+    m_inFlightTarget = m_pendingTarget;
+    m_inFlightAccurate = m_pendingAccurate;
+    m_stats.lastDragSeeks++;
+    m_stats.totalSeeks++;
+    m_timeoutTimer.start();
+
+    emit seekRequested(m_inFlightTarget, m_inFlightAccurate);
+}
+
+void SeekCoordinator::onSeekTimeout()
+{
+    seekCompleted();
+}
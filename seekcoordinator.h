@@ -0,0 +1,72 @@
+#ifndef SEEKCOORDINATOR_H
+#define SEEKCOORDINATOR_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QTimer>
+
+// 进度条跳转合并：同一时间只有一个跳转在进行，期间的新目标只保留最新一个
+// 拖动中发出关键帧预览跳转，松开时发出一次精确跳转；程序设置进度条位置不触发跳转
+// 后端（QMediaPlayer 或 VideoPlayer）通过 seekRequested 执行跳转，完成后回调 seekCompleted/positionReached
+class SeekCoordinator : public QObject
+{
+    Q_OBJECT
+public:
+    // 一次拖动的统计，时间单位毫秒
+    struct Stats {
+        qint64 drags = 0;
+        int lastDragMoves = 0;      // 拖动中收到的位置变化次数
+        int lastDragSeeks = 0;      // 实际发出的跳转次数（含松开后的精确跳转）
+        double lastSettleTime = 0.0; // 松开到精确跳转完成
+        qint64 totalSeeks = 0;
+    };
+
+    explicit SeekCoordinator(QObject *parent = nullptr);
+
+    bool isScrubbing() const;
+    Stats getStats() const;
+
+    // 后端没有完成回调时，超过该时间视为完成，继续发送等待中的目标
+    void setSeekTimeout(int ms);
+
+public slots:
+    // 与 QAbstractSlider 的 sliderPressed/sliderMoved/sliderReleased 对应
+    void beginScrub();
+    void scrubTo(qint64 position);
+    void endScrub(qint64 position);
+
+    // 非拖动的跳转（点击进度条、快捷键），直接精确跳转
+    void requestSeek(qint64 position);
+
+    // 后端报告跳转完成（VideoPlayer::seekFinished）
+    void seekCompleted();
+    // 后端报告播放位置（QMediaPlayer::positionChanged），到达目标附近视为完成
+    void positionReached(qint64 position);
+
+signals:
+    void seekRequested(qint64 position, bool accurate);
+    // 松开后的精确跳转完成
+    void seekSettled(qint64 position, double settleTime);
+
+private:
+    void submit(qint64 position, bool accurate);
+    void dispatchPending();
+    void onSeekTimeout();
+
+    // 位置到达目标的容差（毫秒）
+    static const qint64 SettleTolerance = 500;
+
+    bool m_scrubbing;
+    bool m_inFlight;
+    qint64 m_inFlightTarget;
+    bool m_inFlightAccurate;
+    bool m_hasPending;
+    qint64 m_pendingTarget;
+    bool m_pendingAccurate;
+    bool m_settling;
+    QTimer m_timeoutTimer;
+    QElapsedTimer m_settleTimer;
+    Stats m_stats;
+};
+
+#endif // SEEKCOORDINATOR_H
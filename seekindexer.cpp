@@ -0,0 +1,169 @@
+#include "seekindexer.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <algorithm>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+// 检查点间隔（毫秒）
+static const int kCheckpointInterval = 2000;
+
+SeekIndexer::SeekIndexer(const QString &mediaPath, QObject *parent)
+    : QThread(parent),
+      m_mediaPath(mediaPath)
+{
+}
+
+SeekIndexer::~SeekIndexer()
+{
+    stop();
+}
+
+QString SeekIndexer::mediaPath() const
+{
+    return m_mediaPath;
+}
+
+void SeekIndexer::stop()
+{
+    requestInterruption();
+    wait();
+}
+
+void SeekIndexer::run()
+{
+    QByteArray path = m_mediaPath.toUtf8();
+    AVFormatContext *formatContext = nullptr;
+    if (avformat_open_input(&formatContext, path.constData(), nullptr, nullptr) < 0) {
+        emit indexFailed("索引: 无法打开文件");
+        return;
+    }
+    if (avformat_find_stream_info(formatContext, nullptr) < 0) {
+        avformat_close_input(&formatContext);
+        emit indexFailed("索引: 无法获取流信息");
+        return;
+    }
+
+    int streamIndex = av_find_best_stream(formatContext, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (streamIndex < 0) {
+        avformat_close_input(&formatContext);
+        emit indexFailed("索引: 未找到视频流");
+        return;
+    }
+    AVRational timeBase = formatContext->streams[streamIndex]->time_base;
+
+    // 其他流的包直接丢弃，不做解析
+    for (unsigned int i = 0; i < formatContext->nb_streams; i++) {
+        if (static_cast<int>(i) != streamIndex) {
+            formatContext->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+
+    // 有未完成的检查点时从最后一个关键帧继续（它的 GOP 长度还未统计完）
+    QVector<SeekIndexFile::Entry> entries;
+    int savedStream = -1;
+    qint64 resumePos = 0;
+    bool complete = false;
+    if (SeekIndexFile::load(m_mediaPath, &savedStream, &entries, &resumePos, &complete)
+            && savedStream == streamIndex) {
+        if (complete) {
+            avformat_close_input(&formatContext);
+            emit indexReady(m_mediaPath);
+            return;
+        }
+        if (!entries.isEmpty()) {
+            resumePos = entries.last().pos;
+            entries.removeLast();
+        }
+        if (resumePos > 0 && av_seek_frame(formatContext, -1, resumePos, AVSEEK_FLAG_BYTE) < 0) {
+            entries.clear();
+            resumePos = 0;
+        }
+        qDebug() << "继续建立索引:" << m_mediaPath << "已有" << entries.size() << "个关键帧";
+    } else {
+        entries.clear();
+    }
+
+    qint64 fileSize = formatContext->pb ? avio_size(formatContext->pb) : -1;
+    AVPacket *packet = av_packet_alloc();
+    // 继续时已有的条目都已统计完，本次打开第一个关键帧之前读到的包不属于任何条目
+    int gopSize = 0;
+    bool entryOpen = false;
+    qint64 lastKeyPos = entries.isEmpty() ? -1 : entries.last().pos;
+    int lastPercent = -1;
+    bool failed = false;
+    QElapsedTimer checkpoint;
+    checkpoint.start();
+
+    while (!isInterruptionRequested()) {
+        int ret = av_read_frame(formatContext, packet);
+        if (ret == AVERROR_EOF) {
+            complete = true;
+            break;
+        } else if (ret == AVERROR(EAGAIN)) {
+            continue;
+        } else if (ret < 0) {
+            failed = true;
+            break;
+        }
+
+        if (packet->stream_index == streamIndex) {
+            int64_t pts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+            // 按字节跳转可能落在已有条目之前，跳过重复的关键帧
+            if ((packet->flags & AV_PKT_FLAG_KEY) && packet->pos > lastKeyPos && pts != AV_NOPTS_VALUE) {
+                if (entryOpen) {
+                    entries.last().gopSize = gopSize;
+                }
+                entries.append(SeekIndexFile::Entry{pts, packet->pos, 0, 0});
+                lastKeyPos = packet->pos;
+                entryOpen = true;
+                gopSize = 0;
+            }
+            if (entryOpen) {
+                gopSize++;
+            }
+        }
+
+        if (fileSize > 0 && packet->pos >= 0) {
+            int percent = static_cast<int>(packet->pos * 100 / fileSize);
+            if (percent != lastPercent) {
+                lastPercent = percent;
+                emit progressChanged(percent);
+            }
+        }
+        av_packet_unref(packet);
+
+        if (checkpoint.elapsed() > kCheckpointInterval) {
+            SeekIndexFile::save(m_mediaPath, streamIndex, timeBase.num, timeBase.den, entries,
+                                entries.isEmpty() ? 0 : entries.last().pos, false);
+            checkpoint.restart();
+        }
+    }
+
+    av_packet_free(&packet);
+    avformat_close_input(&formatContext);
+
+    if (complete) {
+        if (entryOpen) {
+            entries.last().gopSize = gopSize;
+        }
+        // 按 pts 排序以便二分查找（B 帧流中关键帧的文件顺序与 pts 顺序一般一致）
+        std::stable_sort(entries.begin(), entries.end(),
+                         [](const SeekIndexFile::Entry &a, const SeekIndexFile::Entry &b) { return a.pts < b.pts; });
+    }
+
+    if (!SeekIndexFile::save(m_mediaPath, streamIndex, timeBase.num, timeBase.den, entries,
+                             entries.isEmpty() ? 0 : entries.last().pos, complete)) {
+        emit indexFailed("索引: 无法写入索引文件");
+        return;
+    }
+
+    if (complete) {
+        qDebug() << "索引完成:" << m_mediaPath << entries.size() << "个关键帧";
+        emit indexReady(m_mediaPath);
+    } else if (failed) {
+        emit indexFailed("索引: 读取文件失败");
+    }
+}
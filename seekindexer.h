@@ -0,0 +1,33 @@
+#ifndef SEEKINDEXER_H
+#define SEEKINDEXER_H
+
+#include <QThread>
+#include <QString>
+#include "seekindexfile.h"
+
+// 后台建立关键帧索引：只解复用不解码，遍历一次视频包，记录关键帧 pts、字节偏移和 GOP 长度
+// 以最低优先级运行，定期写入检查点；中断后下次从检查点继续
+class SeekIndexer : public QThread
+{
+    Q_OBJECT
+public:
+    explicit SeekIndexer(const QString &mediaPath, QObject *parent = nullptr);
+    ~SeekIndexer();
+
+    QString mediaPath() const;
+    // 中断并等待线程退出，已扫描部分写入检查点
+    void stop();
+
+signals:
+    void progressChanged(int percent);
+    void indexReady(const QString &mediaPath);
+    void indexFailed(const QString &errorMessage);
+
+protected:
+    void run() override;
+
+private:
+    QString m_mediaPath;
+};
+
+#endif // SEEKINDEXER_H
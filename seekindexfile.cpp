@@ -0,0 +1,193 @@
+#include "seekindexfile.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cstring>
+
+static const char kMagic[4] = {'K', 'F', 'I', 'X'};
+static const quint32 kVersion = 1;
+
+SeekIndexFile::SeekIndexFile()
+    : m_map(nullptr),
+      m_header(nullptr),
+      m_entries(nullptr),
+      m_count(0)
+{
+    static_assert(sizeof(Header) == 56, "SeekIndexFile::Header layout");
+    static_assert(sizeof(Entry) == 24, "SeekIndexFile::Entry layout");
+}
+
+SeekIndexFile::~SeekIndexFile()
+{
+    close();
+}
+
+QString SeekIndexFile::sidecarPath(const QString &mediaPath)
+{
+    // 媒体目录不可写（如只读共享）时放到缓存目录
+    QFileInfo info(mediaPath);
+    if (QFileInfo(info.absolutePath()).isWritable()) {
+        return info.absoluteFilePath() + ".kfidx";
+    }
+
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/seekindex";
+    QDir().mkpath(dir);
+    QByteArray hash = QCryptographicHash::hash(info.absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+    return dir + "/" + QString::fromLatin1(hash) + ".kfidx";
+}
+
+bool SeekIndexFile::open(const QString &mediaPath)
+{
+    close();
+
+    m_file.setFileName(sidecarPath(mediaPath));
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    Header header;
+    if (!readHeader(m_file, mediaPath, &header) || !header.complete) {
+        close();
+        return false;
+    }
+
+    m_map = m_file.map(0, m_file.size());
+    if (!m_map) {
+        close();
+        return false;
+    }
+
+    m_header = reinterpret_cast<const Header *>(m_map);
+    m_entries = reinterpret_cast<const Entry *>(m_map + sizeof(Header));
+    m_count = static_cast<int>(header.count);
+    return true;
+}
+
+void SeekIndexFile::close()
+{
+    if (m_map) {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+    }
+    m_file.close();
+    m_header = nullptr;
+    m_entries = nullptr;
+    m_count = 0;
+}
+
+bool SeekIndexFile::isOpen() const
+{
+    return m_map != nullptr;
+}
+
+int SeekIndexFile::streamIndex() const
+{
+    return m_header ? m_header->streamIndex : -1;
+}
+
+int SeekIndexFile::size() const
+{
+    return m_count;
+}
+
+const SeekIndexFile::Entry *SeekIndexFile::entries() const
+{
+    return m_entries;
+}
+
+bool SeekIndexFile::lookup(qint64 target, Entry *entry) const
+{
+    if (!m_entries || m_count == 0) {
+        return false;
+    }
+
+    const Entry *end = m_entries + m_count;
+    const Entry *next = std::upper_bound(m_entries, end, target,
+                                         [](qint64 pts, const Entry &e) { return pts < e.pts; });
+    if (next == m_entries) {
+        return false;
+    }
+
+    if (entry) {
+        *entry = *(next - 1);
+    }
+    return true;
+}
+
+bool SeekIndexFile::load(const QString &mediaPath, int *streamIndex, QVector<Entry> *entries,
+                         qint64 *resumePos, bool *complete)
+{
+    QFile file(sidecarPath(mediaPath));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    Header header;
+    if (!readHeader(file, mediaPath, &header)) {
+        return false;
+    }
+
+    entries->resize(static_cast<int>(header.count));
+    qint64 bytes = static_cast<qint64>(header.count) * sizeof(Entry);
+    if (file.read(reinterpret_cast<char *>(entries->data()), bytes) != bytes) {
+        entries->clear();
+        return false;
+    }
+
+    *streamIndex = header.streamIndex;
+    *resumePos = header.resumePos;
+    *complete = header.complete != 0;
+    return true;
+}
+
+bool SeekIndexFile::save(const QString &mediaPath, int streamIndex, int timeBaseNum, int timeBaseDen,
+                         const QVector<Entry> &entries, qint64 resumePos, bool complete)
+{
+    QFileInfo info(mediaPath);
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.mediaSize = info.size();
+    header.mediaModified = info.lastModified().toMSecsSinceEpoch();
+    header.streamIndex = streamIndex;
+    header.timeBaseNum = timeBaseNum;
+    header.timeBaseDen = timeBaseDen;
+    header.complete = complete ? 1 : 0;
+    header.resumePos = resumePos;
+    header.count = static_cast<quint32>(entries.size());
+
+    // 先写临时文件再替换，中途退出不会留下损坏的索引
+    QSaveFile file(sidecarPath(mediaPath));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(entries.constData()),
+               static_cast<qint64>(entries.size()) * sizeof(Entry));
+    return file.commit();
+}
+
+bool SeekIndexFile::readHeader(QFile &file, const QString &mediaPath, Header *header)
+{
+    if (file.read(reinterpret_cast<char *>(header), sizeof(Header)) != sizeof(Header)) {
+        return false;
+    }
+    if (memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion) {
+        return false;
+    }
+
+    // 媒体文件被修改或替换后索引作废
+    QFileInfo info(mediaPath);
+    if (header->mediaSize != info.size() || header->mediaModified != info.lastModified().toMSecsSinceEpoch()) {
+        return false;
+    }
+
+    qint64 expected = sizeof(Header) + static_cast<qint64>(header->count) * sizeof(Entry);
+    return file.size() == expected;
+}
@@ -0,0 +1,67 @@
+#ifndef SEEKINDEXFILE_H
+#define SEEKINDEXFILE_H
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+// 关键帧索引旁路文件（<媒体文件>.kfidx）：固定长度文件头 + 按 pts 排序的定长条目
+// 读取时整体内存映射，二分查找，不产生额外 I/O；媒体文件大小或修改时间变化后失效
+class SeekIndexFile
+{
+public:
+    struct Entry {
+        qint64 pts;         // 视频流时间基
+        qint64 pos;         // 关键帧数据包在文件中的字节偏移
+        qint32 gopSize;     // 到下一个关键帧之前的视频包数，最后一个为 0
+        qint32 reserved;
+    };
+
+    SeekIndexFile();
+    ~SeekIndexFile();
+
+    static QString sidecarPath(const QString &mediaPath);
+
+    // 只映射与媒体文件匹配且已完成的索引
+    bool open(const QString &mediaPath);
+    void close();
+    bool isOpen() const;
+
+    int streamIndex() const;
+    int size() const;
+    const Entry *entries() const;
+
+    // 找到 target 所在 GOP 的关键帧（最后一个 pts <= target 的条目）
+    bool lookup(qint64 target, Entry *entry) const;
+
+    // 索引器使用：读出已有（可能未完成）的索引用于续建，以及原子地写回
+    static bool load(const QString &mediaPath, int *streamIndex, QVector<Entry> *entries,
+                     qint64 *resumePos, bool *complete);
+    static bool save(const QString &mediaPath, int streamIndex, int timeBaseNum, int timeBaseDen,
+                     const QVector<Entry> &entries, qint64 resumePos, bool complete);
+
+private:
+    struct Header {
+        char magic[4];
+        quint32 version;
+        qint64 mediaSize;
+        qint64 mediaModified;
+        qint32 streamIndex;
+        qint32 timeBaseNum;
+        qint32 timeBaseDen;
+        quint32 complete;
+        qint64 resumePos;       // 未完成时从这里继续解复用
+        quint32 count;
+        quint32 reserved;
+    };
+
+    static bool readHeader(QFile &file, const QString &mediaPath, Header *header);
+
+    QFile m_file;
+    uchar *m_map;
+    const Header *m_header;
+    const Entry *m_entries;
+    int m_count;
+};
+
+#endif // SEEKINDEXFILE_H
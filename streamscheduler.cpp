@@ -0,0 +1,579 @@
+#include "streamscheduler.h"
+#include "ffmpegprocessor.h"
+#include <QDebug>
+#include <QList>
+#include <QRunnable>
+#include <QThread>
+#include <climits>
+#include <limits>
+
+// 读取失败（网络抖动等）后的重试间隔（毫秒）
+static const unsigned long kReaderRetryWait = 10;
+
+struct StreamScheduler::Session {
+    // Queued -> Running 由取出它的工作线程设置，其余状态变化都在 m_mutex 下进行
+    enum class State {
+        Opening,    // 在打开线程池中连接、探测或重新打开
+        Queued,
+        Running,
+        Timed,
+        Parked,     // 队列已空、暂停、出错或播放结束，由读取线程或控制操作重新排队
+        Control,    // 读取线程正在执行控制操作，工作线程不会取到
+        Done
+    };
+
+    FFmpegProcessor *processor = nullptr;
+    QString url;
+    std::atomic<Priority> priority{Priority::Normal};
+    std::atomic<State> state{State::Opening};
+    std::atomic<bool> removed{false};
+    // 读取线程请求执行控制操作，持有该流的工作线程在时间片结束后交出
+    std::atomic<bool> controlRequested{false};
+    qint64 due = 0;
+    QVector<std::function<void()>> tasks;
+    QThread *reader = nullptr;
+    QWaitCondition readerWake;
+    // 读取线程因队列已满等原因等待，工作线程取走数据包后唤醒
+    bool readerWaiting = false;
+};
+
+// 工作线程的就绪队列：自己从头部取，其他线程从尾部窃取
+class StreamScheduler::Worker
+{
+public:
+    QThread *thread = nullptr;
+
+    void push(Session *session, bool front)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (front) {
+            m_queue.prepend(session);
+        } else {
+            m_queue.append(session);
+        }
+    }
+
+    Session *popFront()
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_queue.isEmpty() ? nullptr : m_queue.takeFirst();
+    }
+
+    Session *stealBack()
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_queue.isEmpty() ? nullptr : m_queue.takeLast();
+    }
+
+private:
+    QMutex m_mutex;
+    QList<Session *> m_queue;
+};
+
+class StreamScheduler::OpenJob : public QRunnable
+{
+public:
+    OpenJob(StreamScheduler *scheduler, Session *session, bool reopen)
+        : m_scheduler(scheduler), m_session(session), m_reopen(reopen) {}
+
+    void run() override
+    {
+        bool ok = false;
+        if (!m_session->removed) {
+            if (m_reopen) {
+                ok = m_session->processor->reopen();
+            } else {
+                m_session->processor->setCooperative(true);
+                ok = m_session->processor->openStream(m_session->url);
+            }
+        }
+        m_scheduler->openFinished(m_session, ok);
+    }
+
+private:
+    StreamScheduler *m_scheduler;
+    Session *m_session;
+    bool m_reopen;
+};
+
+StreamScheduler::StreamScheduler(int workerCount, QObject *parent)
+    : QObject(parent),
+      m_nextWorker(0),
+      m_queued(0),
+      m_nextDue(std::numeric_limits<qint64>::max()),
+      m_slices(0),
+      m_steals(0),
+      m_timedWaits(0),
+      m_wakeups(0),
+      m_backgroundFrameRate(10.0),
+      m_stopping(false)
+{
+    m_clock.start();
+
+    int count = workerCount > 0 ? workerCount : QThread::idealThreadCount();
+    count = qMax(1, count);
+    // 网络连接大部分时间在等待，打开线程可以比工作线程多
+    m_openPool.setMaxThreadCount(qMax(4, count));
+
+    for (int i = 0; i < count; i++) {
+        Worker *worker = new Worker;
+        worker->thread = QThread::create([this, i] { workerLoop(i); });
+        m_workers.append(worker);
+    }
+    for (Worker *worker : m_workers) {
+        worker->thread->start();
+    }
+    qDebug() << "解码调度器: 工作线程" << count;
+}
+
+StreamScheduler::~StreamScheduler()
+{
+    QList<FFmpegProcessor *> processors;
+    {
+        QMutexLocker locker(&m_mutex);
+        processors = m_sessions.keys();
+    }
+    for (FFmpegProcessor *processor : processors) {
+        removeStream(processor);
+    }
+    m_openPool.waitForDone();
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_wake.wakeAll();
+    }
+    for (Worker *worker : m_workers) {
+        worker->thread->wait();
+        delete worker->thread;
+        delete worker;
+    }
+}
+
+void StreamScheduler::addStream(FFmpegProcessor *processor, const QString &url, Priority priority)
+{
+    Session *session = new Session;
+    session->processor = processor;
+    session->url = url;
+    session->priority = priority;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_sessions.contains(processor)) {
+            delete session;
+            return;
+        }
+        m_sessions.insert(processor, session);
+        applyPriorityLocked(session);
+    }
+
+    m_openPool.start(new OpenJob(this, session, false));
+}
+
+void StreamScheduler::removeStream(FFmpegProcessor *processor)
+{
+    Session *session = nullptr;
+    QThread *reader = nullptr;
+    {
+        QMutexLocker locker(&m_mutex);
+        session = m_sessions.take(processor);
+        if (!session) {
+            return;
+        }
+
+        // 正在打开或读取的流立即返回
+        session->removed = true;
+        processor->interrupt();
+        session->readerWake.wakeAll();
+
+        Session::State state = session->state;
+        if (state == Session::State::Timed) {
+            removeTimerLocked(session);
+            session->state = Session::State::Done;
+        } else if (state == Session::State::Parked) {
+            session->state = Session::State::Done;
+        }
+        m_stateChanged.wakeAll();
+        // 排队、执行、控制或打开中的会话由持有它的线程收尾
+        while (session->state != Session::State::Done) {
+            m_stateChanged.wait(&m_mutex);
+        }
+        reader = session->reader;
+        session->reader = nullptr;
+    }
+
+    if (reader) {
+        reader->wait();
+        delete reader;
+    }
+    processor->closeStream();
+    processor->clearInterrupt();
+    delete session;
+}
+
+void StreamScheduler::setPriority(FFmpegProcessor *processor, Priority priority)
+{
+    QMutexLocker locker(&m_mutex);
+    Session *session = m_sessions.value(processor);
+    if (!session || session->priority == priority) {
+        return;
+    }
+    session->priority = priority;
+    applyPriorityLocked(session);
+}
+
+void StreamScheduler::post(FFmpegProcessor *processor, std::function<void()> task)
+{
+    QMutexLocker locker(&m_mutex);
+    Session *session = m_sessions.value(processor);
+    if (!session) {
+        return;
+    }
+    session->tasks.append(std::move(task));
+    session->readerWake.wakeAll();
+}
+
+void StreamScheduler::setBackgroundFrameRate(double fps)
+{
+    QMutexLocker locker(&m_mutex);
+    m_backgroundFrameRate = fps;
+    for (Session *session : qAsConst(m_sessions)) {
+        applyPriorityLocked(session);
+    }
+}
+
+double StreamScheduler::backgroundFrameRate() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_backgroundFrameRate;
+}
+
+StreamScheduler::Stats StreamScheduler::stats() const
+{
+    Stats stats;
+    stats.workers = m_workers.size();
+    stats.slices = m_slices;
+    stats.steals = m_steals;
+    stats.timedWaits = m_timedWaits;
+    stats.wakeups = m_wakeups;
+    QMutexLocker locker(&m_mutex);
+    stats.streams = m_sessions.size();
+    return stats;
+}
+
+void StreamScheduler::workerLoop(int index)
+{
+    while (Session *session = nextSession(index)) {
+        runSlice(session, index);
+    }
+}
+
+// 依次取：到期的定时会话、自己的队列、其他线程的队列，都没有时休眠到最早的到期时间
+StreamScheduler::Session *StreamScheduler::nextSession(int index)
+{
+    Worker *worker = m_workers[index];
+    int count = m_workers.size();
+
+    while (true) {
+        if (m_nextDue <= now()) {
+            QMutexLocker locker(&m_mutex);
+            if (Session *session = takeDueLocked(now())) {
+                return session;
+            }
+        }
+
+        if (Session *session = worker->popFront()) {
+            m_queued--;
+            session->state = Session::State::Running;
+            return session;
+        }
+
+        for (int i = 1; i < count; i++) {
+            if (Session *session = m_workers[(index + i) % count]->stealBack()) {
+                m_queued--;
+                m_steals++;
+                session->state = Session::State::Running;
+                return session;
+            }
+        }
+
+        QMutexLocker locker(&m_mutex);
+        if (m_stopping) {
+            return nullptr;
+        }
+        qint64 current = now();
+        if (Session *session = takeDueLocked(current)) {
+            return session;
+        }
+        if (m_queued > 0) {
+            continue;
+        }
+        unsigned long timeout = ULONG_MAX;
+        if (!m_timers.isEmpty()) {
+            timeout = static_cast<unsigned long>(qMax<qint64>(1, (m_timers.firstKey() - current + 999) / 1000));
+        }
+        m_wake.wait(&m_mutex, timeout);
+    }
+}
+
+void StreamScheduler::runSlice(Session *session, int index)
+{
+    qint64 wait = -1;
+    if (!session->removed && !session->controlRequested) {
+        wait = session->processor->step(sliceBudget(session->priority));
+    }
+    m_slices++;
+
+    QMutexLocker locker(&m_mutex);
+    // 本时间片腾出了队列空间或发现需要重新打开，唤醒等待的读取线程
+    if (session->readerWaiting && (session->processor->canDemux() || session->processor->needsReopen())) {
+        session->readerWake.wakeAll();
+    }
+    if (session->removed) {
+        session->state = Session::State::Done;
+        m_stateChanged.wakeAll();
+    } else if (session->controlRequested) {
+        // 交给等待执行控制操作的读取线程
+        session->state = Session::State::Control;
+        m_stateChanged.wakeAll();
+    } else if (wait == 0) {
+        enqueueLocked(session, index);
+    } else if (wait > 0) {
+        session->state = Session::State::Timed;
+        session->due = now() + wait;
+        m_timers.insert(session->due, session);
+        m_timedWaits++;
+        if (session->due < m_nextDue) {
+            m_nextDue = session->due;
+            // 休眠中的线程按新的到期时间重新计算超时
+            m_wake.wakeOne();
+        }
+    } else if (session->processor->hasDecodableData()) {
+        // 读取线程在本时间片中放入了新的数据包
+        enqueueLocked(session, index);
+    } else {
+        session->state = Session::State::Parked;
+    }
+}
+
+// 每路流的读取线程：阻塞读取并放入数据包队列，执行投递的控制操作，探测缓存不符时转去重新打开
+void StreamScheduler::readerLoop(Session *session)
+{
+    FFmpegProcessor *processor = session->processor;
+
+    while (!session->removed) {
+        bool hasTasks = false;
+        {
+            QMutexLocker locker(&m_mutex);
+            hasTasks = !session->tasks.isEmpty();
+        }
+        if (hasTasks) {
+            runControl(session);
+            continue;
+        }
+
+        if (processor->needsReopen()) {
+            if (!acquireControl(session)) {
+                return;
+            }
+            QMutexLocker locker(&m_mutex);
+            if (session->removed) {
+                session->state = Session::State::Done;
+                m_stateChanged.wakeAll();
+                return;
+            }
+            // 本线程就此退出，重新打开完成后由 openFinished 启动新的读取线程
+            session->state = Session::State::Opening;
+            m_openPool.start(new OpenJob(this, session, true));
+            return;
+        }
+
+        if (!processor->canDemux()) {
+            // 队列已满时等工作线程取走数据包，暂停或读到末尾时等控制操作；
+            // 先登记再复查，工作线程在两次检查之间取走数据包也不会错过唤醒
+            QMutexLocker locker(&m_mutex);
+            if (!session->removed && session->tasks.isEmpty()) {
+                session->readerWaiting = true;
+                if (!processor->canDemux() && !processor->needsReopen()) {
+                    session->readerWake.wait(&m_mutex);
+                }
+                session->readerWaiting = false;
+            }
+            continue;
+        }
+
+        bool ok = processor->readFrame();
+        // 包括读到末尾时放入的冲刷空包
+        wakeSession(session);
+        if (!ok && !session->removed && !processor->isEndOfStream() && !processor->needsReopen()) {
+            // 读取失败（网络抖动等），稍后重试
+            QMutexLocker locker(&m_mutex);
+            if (session->tasks.isEmpty()) {
+                session->readerWake.wait(&m_mutex, kReaderRetryWait);
+            }
+        }
+    }
+}
+
+// 等工作线程交出该流：定时和挂起的直接接管，排队和执行中的由工作线程在取出或时间片结束时交出
+bool StreamScheduler::acquireControl(Session *session)
+{
+    QMutexLocker locker(&m_mutex);
+    session->controlRequested = true;
+    while (true) {
+        Session::State state = session->state;
+        if (state == Session::State::Control) {
+            break;
+        }
+        if (state == Session::State::Done) {
+            session->controlRequested = false;
+            return false;
+        }
+        if (state == Session::State::Timed) {
+            removeTimerLocked(session);
+            session->state = Session::State::Control;
+            break;
+        }
+        if (state == Session::State::Parked) {
+            session->state = Session::State::Control;
+            break;
+        }
+        m_stateChanged.wait(&m_mutex);
+    }
+    session->controlRequested = false;
+    return true;
+}
+
+// 控制操作在读取线程中执行（seek 必须与 readFrame 在同一线程），执行期间工作线程不会解码该流
+void StreamScheduler::runControl(Session *session)
+{
+    if (!acquireControl(session)) {
+        return;
+    }
+
+    QVector<std::function<void()>> tasks;
+    {
+        QMutexLocker locker(&m_mutex);
+        tasks.swap(session->tasks);
+    }
+    if (!session->removed) {
+        for (const std::function<void()> &task : qAsConst(tasks)) {
+            task();
+        }
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (session->removed) {
+        session->state = Session::State::Done;
+        m_stateChanged.wakeAll();
+    } else {
+        enqueueLocked(session, m_nextWorker++ % m_workers.size());
+    }
+}
+
+// 读取线程放入数据包后唤醒挂起的流
+void StreamScheduler::wakeSession(Session *session)
+{
+    QMutexLocker locker(&m_mutex);
+    if (session->state == Session::State::Parked && session->processor->hasDecodableData()) {
+        m_wakeups++;
+        enqueueLocked(session, m_nextWorker++ % m_workers.size());
+    }
+}
+
+void StreamScheduler::openFinished(Session *session, bool ok)
+{
+    // 重新打开时上一个读取线程已经退出循环
+    QThread *previousReader = nullptr;
+    {
+        QMutexLocker locker(&m_mutex);
+        previousReader = session->reader;
+        session->reader = nullptr;
+    }
+    if (previousReader) {
+        previousReader->wait();
+        delete previousReader;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (session->removed) {
+            session->state = Session::State::Done;
+            m_stateChanged.wakeAll();
+            return;
+        }
+        if (ok) {
+            session->reader = QThread::create([this, session] { readerLoop(session); });
+            session->reader->start();
+            enqueueLocked(session, m_nextWorker++ % m_workers.size());
+        } else {
+            session->state = Session::State::Parked;
+        }
+    }
+
+    if (!ok) {
+        qDebug() << "解码调度器: 打开失败" << session->url << session->processor->getErrorString();
+    }
+    emit streamOpened(session->processor, ok);
+}
+
+// 焦点画面排在队列头部，尽快得到下一个时间片
+void StreamScheduler::enqueueLocked(Session *session, int index)
+{
+    session->state = Session::State::Queued;
+    m_workers[index]->push(session, session->priority == Priority::Focused);
+    m_queued++;
+    m_wake.wakeOne();
+}
+
+StreamScheduler::Session *StreamScheduler::takeDueLocked(qint64 now)
+{
+    if (m_timers.isEmpty() || m_timers.firstKey() > now) {
+        return nullptr;
+    }
+
+    Session *session = m_timers.begin().value();
+    m_timers.erase(m_timers.begin());
+    m_nextDue = m_timers.isEmpty() ? std::numeric_limits<qint64>::max() : m_timers.firstKey();
+    session->state = Session::State::Running;
+    return session;
+}
+
+void StreamScheduler::removeTimerLocked(Session *session)
+{
+    auto it = m_timers.find(session->due);
+    while (it != m_timers.end() && it.key() == session->due) {
+        if (it.value() == session) {
+            m_timers.erase(it);
+            break;
+        }
+        ++it;
+    }
+    m_nextDue = m_timers.isEmpty() ? std::numeric_limits<qint64>::max() : m_timers.firstKey();
+}
+
+// 后台画面降低显示帧率并跳过非参考帧，两项设置都可以在任意线程修改
+void StreamScheduler::applyPriorityLocked(Session *session)
+{
+    bool background = session->priority == Priority::Background;
+    session->processor->setFrameRateLimit(background ? m_backgroundFrameRate : 0.0);
+    session->processor->setSkipNonReference(background);
+}
+
+// 每个时间片最多处理的数据包数
+int StreamScheduler::sliceBudget(Priority priority)
+{
+    switch (priority) {
+    case Priority::Focused:
+        return 8;
+    case Priority::Normal:
+        return 4;
+    default:
+        return 2;
+    }
+}
+
+qint64 StreamScheduler::now() const
+{
+    return m_clock.nsecsElapsed() / 1000;
+}
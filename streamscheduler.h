@@ -0,0 +1,105 @@
+#ifndef STREAMSCHEDULER_H
+#define STREAMSCHEDULER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMultiMap>
+#include <QMutex>
+#include <QThreadPool>
+#include <QVector>
+#include <QWaitCondition>
+#include <atomic>
+#include <functional>
+
+class FFmpegProcessor;
+
+// 多路流共享的解码调度器：固定数量（默认 CPU 核心数）的工作线程轮流调用各路流的 FFmpegProcessor::step，
+// 每个工作线程有自己的就绪队列，空闲时从其他线程的队列尾部窃取
+// 网络读取无法做到非阻塞，每路流有一个读取线程把数据包放入 PacketQueue，工作线程只做解码、转换和显示，
+// 队列中有数据包即为就绪；读取线程大部分时间阻塞在 I/O 上，不占用 CPU
+// 时间片大小和显示帧率按优先级分配：焦点画面全帧率，后台画面降帧率并跳过非参考帧
+// 连接、探测以及探测缓存不符时的重新打开在单独的有上限的线程池中完成
+class StreamScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    enum class Priority {
+        Background,
+        Normal,
+        Focused
+    };
+
+    struct Stats {
+        int workers = 0;
+        int streams = 0;
+        qint64 slices = 0;      // 执行的时间片总数
+        qint64 steals = 0;      // 从其他工作线程窃取的次数
+        qint64 timedWaits = 0;  // 帧未到显示时间或等待音频消费而定时等待的次数
+        qint64 wakeups = 0;     // 读取线程放入数据包后唤醒挂起的流的次数
+    };
+
+    // workerCount 为 0 时按 CPU 核心数
+    explicit StreamScheduler(int workerCount = 0, QObject *parent = nullptr);
+    ~StreamScheduler();
+
+    // processor 由调用方持有，removeStream 返回之前不能销毁；打开结果通过 streamOpened 通知
+    void addStream(FFmpegProcessor *processor, const QString &url, Priority priority = Priority::Normal);
+    // 阻塞到没有线程再使用该流，然后关闭流
+    void removeStream(FFmpegProcessor *processor);
+    void setPriority(FFmpegProcessor *processor, Priority priority);
+    // 在该流的读取线程中执行（seek、pause、resume 等），执行期间没有工作线程在解码该流
+    void post(FFmpegProcessor *processor, std::function<void()> task);
+
+    // 后台画面的显示帧率，默认 10
+    void setBackgroundFrameRate(double fps);
+    double backgroundFrameRate() const;
+
+    Stats stats() const;
+
+signals:
+    void streamOpened(FFmpegProcessor *processor, bool ok);
+
+private:
+    struct Session;
+    class Worker;
+    class OpenJob;
+
+    void workerLoop(int index);
+    Session *nextSession(int index);
+    void runSlice(Session *session, int index);
+    void readerLoop(Session *session);
+    bool acquireControl(Session *session);
+    void runControl(Session *session);
+    void wakeSession(Session *session);
+    void openFinished(Session *session, bool ok);
+    void enqueueLocked(Session *session, int index);
+    Session *takeDueLocked(qint64 now);
+    void removeTimerLocked(Session *session);
+    void applyPriorityLocked(Session *session);
+    static int sliceBudget(Priority priority);
+    qint64 now() const;
+
+    QVector<Worker *> m_workers;
+    QThreadPool m_openPool;
+    QElapsedTimer m_clock;
+    std::atomic<int> m_nextWorker;
+    std::atomic<int> m_queued;
+    // 最早的定时到期时间（m_clock 微秒），工作线程不加锁先检查
+    std::atomic<qint64> m_nextDue;
+    std::atomic<qint64> m_slices;
+    std::atomic<qint64> m_steals;
+    std::atomic<qint64> m_timedWaits;
+    std::atomic<qint64> m_wakeups;
+
+    // 以下由 m_mutex 保护
+    mutable QMutex m_mutex;
+    QWaitCondition m_wake;
+    QWaitCondition m_stateChanged;
+    QHash<FFmpegProcessor *, Session *> m_sessions;
+    QMultiMap<qint64, Session *> m_timers;
+    double m_backgroundFrameRate;
+    bool m_stopping;
+};
+
+#endif // STREAMSCHEDULER_H
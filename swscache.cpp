@@ -0,0 +1,78 @@
+#include "swscache.h"
+
+SwsContextCache::SwsContextCache(int capacity)
+    : m_capacity(qMax(1, capacity)),
+      m_hits(0),
+      m_misses(0)
+{
+}
+
+SwsContextCache::~SwsContextCache()
+{
+    clear();
+}
+
+SwsContext *SwsContextCache::get(int srcWidth, int srcHeight, AVPixelFormat srcFormat,
+                                 int dstWidth, int dstHeight, AVPixelFormat dstFormat, int flags,
+                                 int colorspace, bool srcFullRange)
+{
+    for (int i = 0; i < m_entries.size(); i++) {
+        const Entry &entry = m_entries.at(i);
+        if (entry.srcWidth == srcWidth && entry.srcHeight == srcHeight && entry.srcFormat == srcFormat
+                && entry.dstWidth == dstWidth && entry.dstHeight == dstHeight
+                && entry.dstFormat == dstFormat && entry.flags == flags
+                && entry.colorspace == colorspace && entry.srcFullRange == srcFullRange) {
+            if (i != 0) {
+                m_entries.move(i, 0);
+            }
+            m_hits++;
+            return m_entries.first().context;
+        }
+    }
+
+    m_misses++;
+    SwsContext *context = sws_getContext(srcWidth, srcHeight, srcFormat,
+                                         dstWidth, dstHeight, dstFormat,
+                                         flags, nullptr, nullptr, nullptr);
+    if (!context) {
+        return nullptr;
+    }
+    // 默认按 BT.601 有限范围转换，这里改为源的矩阵和范围；RGB 输出为全范围
+    // 源不是 YUV 时不支持设置，返回失败也不影响转换
+    const int *coefficients = sws_getCoefficients(colorspace);
+    sws_setColorspaceDetails(context, coefficients, srcFullRange ? 1 : 0,
+                             coefficients, 1, 0, 1 << 16, 1 << 16);
+
+    // 淘汰最久未使用的上下文
+    while (m_entries.size() >= m_capacity) {
+        sws_freeContext(m_entries.last().context);
+        m_entries.removeLast();
+    }
+
+    Entry entry = { srcWidth, srcHeight, srcFormat, dstWidth, dstHeight, dstFormat, flags, colorspace, srcFullRange, context };
+    m_entries.prepend(entry);
+    return context;
+}
+
+void SwsContextCache::clear()
+{
+    for (const Entry &entry : m_entries) {
+        sws_freeContext(entry.context);
+    }
+    m_entries.clear();
+}
+
+int SwsContextCache::size() const
+{
+    return m_entries.size();
+}
+
+qint64 SwsContextCache::hits() const
+{
+    return m_hits;
+}
+
+qint64 SwsContextCache::misses() const
+{
+    return m_misses;
+}
@@ -0,0 +1,51 @@
+#ifndef SWSCACHE_H
+#define SWSCACHE_H
+
+#include <QList>
+
+extern "C" {
+#include <libswscale/swscale.h>
+}
+
+// 按 (源宽高/格式, 目标宽高/格式) 缓存 SwsContext 的小型 LRU
+// 码流中途切换分辨率或像素格式时直接复用已有上下文，不需要重新打开流
+// 只在视频解码线程中使用，不加锁
+class SwsContextCache
+{
+public:
+    explicit SwsContextCache(int capacity = 4);
+    ~SwsContextCache();
+
+    // 取得匹配的转换上下文，不存在时创建，超出容量时淘汰最久未使用的
+    // colorspace 为 SWS_CS_* 色彩矩阵，srcFullRange 为源的取值范围，创建时设置到上下文中
+    SwsContext *get(int srcWidth, int srcHeight, AVPixelFormat srcFormat,
+                    int dstWidth, int dstHeight, AVPixelFormat dstFormat, int flags,
+                    int colorspace = SWS_CS_DEFAULT, bool srcFullRange = false);
+    void clear();
+
+    int size() const;
+    qint64 hits() const;
+    qint64 misses() const;
+
+private:
+    struct Entry {
+        int srcWidth;
+        int srcHeight;
+        AVPixelFormat srcFormat;
+        int dstWidth;
+        int dstHeight;
+        AVPixelFormat dstFormat;
+        int flags;
+        int colorspace;
+        bool srcFullRange;
+        SwsContext *context;
+    };
+
+    // 最近使用的在前
+    QList<Entry> m_entries;
+    int m_capacity;
+    qint64 m_hits;
+    qint64 m_misses;
+};
+
+#endif // SWSCACHE_H
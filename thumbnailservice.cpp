@@ -0,0 +1,359 @@
+#include "thumbnailservice.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QStandardPaths>
+#include <QThread>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libswscale/swscale.h>
+}
+
+namespace {
+
+// 缩略图解码上下文：只解关键帧，单线程，尽量用 lowres 在解码阶段就缩小
+struct KeyframeDecoder {
+    AVFormatContext *formatContext = nullptr;
+    AVCodecContext *codecContext = nullptr;
+    int streamIndex = -1;
+
+    ~KeyframeDecoder()
+    {
+        avcodec_free_context(&codecContext);
+        avformat_close_input(&formatContext);
+    }
+
+    bool open(const QString &url, int targetWidth)
+    {
+        QByteArray urlBytes = url.toUtf8();
+        if (avformat_open_input(&formatContext, urlBytes.constData(), nullptr, nullptr) < 0) {
+            return false;
+        }
+        if (avformat_find_stream_info(formatContext, nullptr) < 0) {
+            return false;
+        }
+
+        AVCodec *codec = nullptr;
+        streamIndex = av_find_best_stream(formatContext, AVMEDIA_TYPE_VIDEO, -1, -1, &codec, 0);
+        if (streamIndex < 0 || !codec) {
+            return false;
+        }
+        for (unsigned int i = 0; i < formatContext->nb_streams; i++) {
+            if (static_cast<int>(i) != streamIndex) {
+                formatContext->streams[i]->discard = AVDISCARD_ALL;
+            }
+        }
+
+        codecContext = avcodec_alloc_context3(codec);
+        if (!codecContext || avcodec_parameters_to_context(codecContext, formatContext->streams[streamIndex]->codecpar) < 0) {
+            return false;
+        }
+        codecContext->thread_count = 1;
+        codecContext->skip_frame = AVDISCARD_NONKEY;
+        codecContext->skip_loop_filter = AVDISCARD_ALL;
+
+        // lowres 每级宽高减半，不低于目标宽度
+        int lowres = 0;
+        while (lowres < codec->max_lowres && (codecContext->width >> (lowres + 1)) >= targetWidth) {
+            lowres++;
+        }
+        codecContext->lowres = lowres;
+
+        return avcodec_open2(codecContext, codec, nullptr) >= 0;
+    }
+
+    double duration() const
+    {
+        if (formatContext->duration != AV_NOPTS_VALUE) {
+            return formatContext->duration / static_cast<double>(AV_TIME_BASE);
+        }
+        AVStream *stream = formatContext->streams[streamIndex];
+        if (stream->duration != AV_NOPTS_VALUE) {
+            return stream->duration * av_q2d(stream->time_base);
+        }
+        return 0.0;
+    }
+
+    // 定位到 seconds 之前最近的关键帧并解出一帧
+    bool decodeAt(double seconds, AVFrame *frame, AVPacket *packet)
+    {
+        int64_t timestamp = static_cast<int64_t>(seconds * AV_TIME_BASE);
+        if (formatContext->start_time != AV_NOPTS_VALUE) {
+            timestamp += formatContext->start_time;
+        }
+        if (av_seek_frame(formatContext, -1, timestamp, AVSEEK_FLAG_BACKWARD) < 0) {
+            return false;
+        }
+        avcodec_flush_buffers(codecContext);
+
+        // 关键帧之后的包不送入解码器，最多读一段距离
+        for (int packets = 0; packets < 512; packets++) {
+            if (av_read_frame(formatContext, packet) < 0) {
+                // 文件末尾，冲刷解码器
+                avcodec_send_packet(codecContext, nullptr);
+                return avcodec_receive_frame(codecContext, frame) == 0;
+            }
+            if (packet->stream_index == streamIndex && (packet->flags & AV_PKT_FLAG_KEY)) {
+                // 送入关键帧后立即冲刷：有 B 帧重排序时解码器会留着这一帧，否则要等下一个关键帧才输出
+                // 下一次定位时的 avcodec_flush_buffers 会让解码器退出冲刷状态
+                avcodec_send_packet(codecContext, packet);
+                av_packet_unref(packet);
+                avcodec_send_packet(codecContext, nullptr);
+                return avcodec_receive_frame(codecContext, frame) == 0;
+            }
+            av_packet_unref(packet);
+        }
+        return false;
+    }
+};
+
+QString cacheKeyFor(const QString &url)
+{
+    // 本地文件加上大小和修改时间，文件被替换后缓存失效
+    QString key = url;
+    QFileInfo info(url);
+    if (info.isFile()) {
+        key += QString("|%1|%2").arg(info.size()).arg(info.lastModified().toMSecsSinceEpoch());
+    }
+    return QString::fromLatin1(QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex());
+}
+
+} // namespace
+
+// 打开文件取时长和宽高比，确定缩略图间隔与雪碧图布局
+class ThumbnailService::PlanJob : public QRunnable
+{
+public:
+    PlanJob(ThumbnailService *service, const QString &url, int generation)
+        : m_service(service), m_url(url), m_generation(generation) {}
+
+    void run() override
+    {
+        KeyframeDecoder decoder;
+        if (!decoder.open(m_url, TileWidth)) {
+            qDebug() << "缩略图: 无法打开" << m_url;
+            return;
+        }
+
+        Layout layout;
+        double duration = decoder.duration();
+        if (duration <= 0.0) {
+            return;
+        }
+        layout.interval = qMax(1.0, duration / MaxTiles);
+        layout.tileCount = qMax(1, static_cast<int>(duration / layout.interval));
+        layout.sheetCount = (layout.tileCount + TilesPerSheet - 1) / TilesPerSheet;
+
+        AVCodecParameters *par = decoder.formatContext->streams[decoder.streamIndex]->codecpar;
+        double aspect = par->width > 0 ? static_cast<double>(par->height) / par->width : 9.0 / 16.0;
+        if (par->sample_aspect_ratio.num > 0 && par->sample_aspect_ratio.den > 0) {
+            aspect /= av_q2d(par->sample_aspect_ratio);
+        }
+        // 保持偶数高度
+        layout.tileHeight = qMax(2, qRound(TileWidth * aspect) & ~1);
+        layout.cacheKey = QString("%1_%2_%3").arg(cacheKeyFor(m_url)).arg(TileWidth).arg(layout.interval, 0, 'f', 3);
+
+        ThumbnailService *service = m_service;
+        int generation = m_generation;
+        QMetaObject::invokeMethod(service, [service, generation, layout] {
+            service->onLayoutReady(generation, layout);
+        }, Qt::QueuedConnection);
+    }
+
+private:
+    ThumbnailService *m_service;
+    QString m_url;
+    int m_generation;
+};
+
+// 生成一张雪碧图（最多 Columns * Rows 个缩略图）
+class ThumbnailService::SheetJob : public QRunnable
+{
+public:
+    SheetJob(ThumbnailService *service, const QString &url, const Layout &layout, int sheet, int generation)
+        : m_service(service), m_url(url), m_layout(layout), m_sheet(sheet), m_generation(generation) {}
+
+    void run() override
+    {
+        // 不与播放解码线程争抢 CPU
+        QThread::currentThread()->setPriority(QThread::LowPriority);
+
+        KeyframeDecoder decoder;
+        if (!decoder.open(m_url, TileWidth)) {
+            return;
+        }
+
+        int tileHeight = m_layout.tileHeight;
+        QImage image(TileWidth * Columns, tileHeight * Rows, QImage::Format_RGB32);
+        image.fill(Qt::black);
+
+        AVFrame *frame = av_frame_alloc();
+        AVPacket *packet = av_packet_alloc();
+        SwsContext *sws = nullptr;
+
+        int first = m_sheet * TilesPerSheet;
+        int last = qMin(first + TilesPerSheet, m_layout.tileCount);
+        for (int tile = first; tile < last; tile++) {
+            if (m_service->m_generation != m_generation) {
+                break;
+            }
+            if (!decoder.decodeAt(tile * m_layout.interval, frame, packet)) {
+                continue;
+            }
+
+            sws = sws_getCachedContext(sws, frame->width, frame->height, static_cast<AVPixelFormat>(frame->format),
+                                       TileWidth, tileHeight, AV_PIX_FMT_BGR0, SWS_BILINEAR,
+                                       nullptr, nullptr, nullptr);
+            if (sws) {
+                // 直接缩放到雪碧图中的对应位置
+                int index = tile - first;
+                uint8_t *dst[4] = { image.bits() + (index / Columns) * tileHeight * image.bytesPerLine()
+                                    + (index % Columns) * TileWidth * 4, nullptr, nullptr, nullptr };
+                int dstLinesize[4] = { image.bytesPerLine(), 0, 0, 0 };
+                sws_scale(sws, frame->data, frame->linesize, 0, frame->height, dst, dstLinesize);
+            }
+            av_frame_unref(frame);
+        }
+
+        sws_freeContext(sws);
+        av_packet_free(&packet);
+        av_frame_free(&frame);
+
+        if (m_service->m_generation != m_generation) {
+            return;
+        }
+        image.save(m_service->sheetPath(m_layout.cacheKey, m_sheet), "JPG", 85);
+
+        ThumbnailService *service = m_service;
+        int generation = m_generation;
+        int sheet = m_sheet;
+        QMetaObject::invokeMethod(service, [service, generation, sheet, image] {
+            service->onSheetReady(generation, sheet, image);
+        }, Qt::QueuedConnection);
+    }
+
+private:
+    ThumbnailService *m_service;
+    QString m_url;
+    Layout m_layout;
+    int m_sheet;
+    int m_generation;
+};
+
+ThumbnailService::ThumbnailService(QObject *parent)
+    : QObject(parent),
+      m_generation(0)
+{
+    // 最多占一半核心，且不超过 4 个线程
+    m_pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() / 2, 4));
+
+    m_cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/thumbnails";
+    QDir().mkpath(m_cacheDir);
+}
+
+ThumbnailService::~ThumbnailService()
+{
+    m_generation++;
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void ThumbnailService::setSource(const QString &url)
+{
+    clear();
+    m_url = url;
+    if (url.isEmpty()) {
+        return;
+    }
+    m_pool.start(new PlanJob(this, url, m_generation));
+}
+
+void ThumbnailService::clear()
+{
+    // 正在运行的任务检查到代号变化后放弃
+    m_generation++;
+    m_pool.clear();
+    m_url.clear();
+    m_layout = Layout();
+    m_sheets.clear();
+    m_sheetReady.clear();
+}
+
+QImage ThumbnailService::thumbnail(double seconds)
+{
+    if (m_layout.tileCount == 0) {
+        return QImage();
+    }
+
+    int tile = qBound(0, static_cast<int>(seconds / m_layout.interval), m_layout.tileCount - 1);
+    int sheet = tile / TilesPerSheet;
+    if (!m_sheetReady.value(sheet)) {
+        return QImage();
+    }
+
+    // 磁盘缓存中的雪碧图在第一次用到时加载
+    auto it = m_sheets.find(sheet);
+    if (it == m_sheets.end()) {
+        QImage image;
+        if (!image.load(sheetPath(m_layout.cacheKey, sheet))) {
+            return QImage();
+        }
+        it = m_sheets.insert(sheet, image);
+    }
+
+    int index = tile - sheet * TilesPerSheet;
+    QRect rect((index % Columns) * TileWidth, (index / Columns) * m_layout.tileHeight,
+               TileWidth, m_layout.tileHeight);
+    return it->copy(rect);
+}
+
+int ThumbnailService::sheetCount() const
+{
+    return m_layout.sheetCount;
+}
+
+int ThumbnailService::readySheets() const
+{
+    return m_sheetReady.count(true);
+}
+
+QString ThumbnailService::sheetPath(const QString &cacheKey, int sheet) const
+{
+    return QString("%1/%2_%3.jpg").arg(m_cacheDir, cacheKey).arg(sheet);
+}
+
+void ThumbnailService::onLayoutReady(int generation, const Layout &layout)
+{
+    if (generation != m_generation) {
+        return;
+    }
+
+    m_layout = layout;
+    m_sheetReady.fill(false, layout.sheetCount);
+
+    // 已缓存的雪碧图直接可用，其余的分发到线程池
+    for (int sheet = 0; sheet < layout.sheetCount; sheet++) {
+        if (QFileInfo::exists(sheetPath(layout.cacheKey, sheet))) {
+            m_sheetReady[sheet] = true;
+            emit sheetReady(sheet);
+        } else {
+            m_pool.start(new SheetJob(this, m_url, layout, sheet, generation));
+        }
+    }
+}
+
+void ThumbnailService::onSheetReady(int generation, int sheet, const QImage &image)
+{
+    if (generation != m_generation || sheet >= m_sheetReady.size()) {
+        return;
+    }
+
+    m_sheets.insert(sheet, image);
+    m_sheetReady[sheet] = true;
+    emit sheetReady(sheet);
+}
@@ -0,0 +1,67 @@
+#ifndef THUMBNAILSERVICE_H
+#define THUMBNAILSERVICE_H
+
+#include <QObject>
+#include <QHash>
+#include <QImage>
+#include <QVector>
+#include <QThreadPool>
+#include <atomic>
+
+// 进度条悬停预览缩略图：用独立的轻量解码器只解关键帧（skip_frame = NONKEY，支持时启用 lowres），
+// 缩放到约 160 像素宽后拼成雪碧图，按文件缓存到磁盘
+// 雪碧图在有上限的线程池中并行生成，线程优先级低于播放解码线程
+class ThumbnailService : public QObject
+{
+    Q_OBJECT
+public:
+    static const int TileWidth = 160;
+    static const int Columns = 10;
+    static const int Rows = 10;
+    static const int TilesPerSheet = Columns * Rows;
+    // 整个时间轴最多生成的缩略图数，间隔最小 1 秒
+    static const int MaxTiles = 600;
+
+    explicit ThumbnailService(QObject *parent = nullptr);
+    ~ThumbnailService();
+
+    // 切换媒体，之前未完成的任务会被放弃
+    void setSource(const QString &url);
+    void clear();
+
+    // 返回 seconds 处（相对开头）的缩略图，尚未生成时返回空图
+    QImage thumbnail(double seconds);
+
+    int sheetCount() const;
+    int readySheets() const;
+
+signals:
+    void sheetReady(int sheet);
+
+private:
+    struct Layout {
+        QString cacheKey;
+        double interval = 0.0;
+        int tileCount = 0;
+        int tileHeight = 0;
+        int sheetCount = 0;
+    };
+
+    class PlanJob;
+    class SheetJob;
+
+    QString sheetPath(const QString &cacheKey, int sheet) const;
+    void onLayoutReady(int generation, const Layout &layout);
+    void onSheetReady(int generation, int sheet, const QImage &image);
+
+    QThreadPool m_pool;
+    std::atomic<int> m_generation;
+
+    QString m_url;
+    Layout m_layout;
+    QHash<int, QImage> m_sheets;
+    QVector<bool> m_sheetReady;
+    QString m_cacheDir;
+};
+
+#endif // THUMBNAILSERVICE_H
@@ -1,6 +1,13 @@
 ﻿#include "tmyvideowidget.h"
+#include "framemailbox.h"
+#include "glvideowidget.h"
+#include "rastervideowidget.h"
+#include "sdlvideowidget.h"
+#include <QOpenGLContext>
+#include <QDebug>
 #include <QKeyEvent>
 #include <QMouseEvent>
+#include <QResizeEvent>
 
 void TMyVideoWidget::keyPressEvent(QKeyEvent *event)
 {//按键事件处理函数，ESC退出全屏状态
@@ -24,7 +31,25 @@ void TMyVideoWidget::mousePressEvent(QMouseEvent *event)
     QVideoWidget::mousePressEvent(event);
 }
 
-TMyVideoWidget::TMyVideoWidget(QWidget *parent):QVideoWidget(parent)
+void TMyVideoWidget::resizeEvent(QResizeEvent *event)
+{//尺寸变化时通知解码端调整输出尺寸
+    QVideoWidget::resizeEvent(event);
+    if (m_glView)
+        m_glView->setGeometry(rect());
+    if (m_rasterView)
+        m_rasterView->setGeometry(rect());
+    if (m_sdlView)
+        m_sdlView->setGeometry(rect());
+    emit viewportSizeChanged(event->size(), devicePixelRatioF());
+}
+
+TMyVideoWidget::TMyVideoWidget(QWidget *parent):QVideoWidget(parent),
+    m_player(nullptr),
+    m_mailbox(nullptr),
+    m_renderBackend(RenderBackend::Raster),
+    m_glView(nullptr),
+    m_rasterView(nullptr),
+    m_sdlView(nullptr)
 {
 
 }
@@ -33,3 +58,112 @@ void TMyVideoWidget::setMediaPlayer(QMediaPlayer *player)
 {//设置播放器
     m_player=player;
 }
+
+void TMyVideoWidget::setRenderBackend(RenderBackend backend)
+{//选择渲染方式，OpenGL 上下文无法创建时直接使用 Raster
+    if (backend == RenderBackend::OpenGL)
+    {
+        QOpenGLContext probe;
+        if (!probe.create())
+        {
+            qDebug() << "无法创建 OpenGL 上下文，使用 Raster 渲染";
+            backend = RenderBackend::Raster;
+        }
+    }
+    createFrameView(backend);
+}
+
+TMyVideoWidget::RenderBackend TMyVideoWidget::renderBackend() const
+{
+    return m_renderBackend;
+}
+
+void TMyVideoWidget::createFrameView(RenderBackend backend)
+{//重建覆盖在视频区域上的渲染子窗口
+    if (m_glView)
+    {
+        m_glView->deleteLater();
+        m_glView = nullptr;
+    }
+    if (m_rasterView)
+    {
+        m_rasterView->deleteLater();
+        m_rasterView = nullptr;
+    }
+    if (m_sdlView)
+    {
+        m_sdlView->deleteLater();
+        m_sdlView = nullptr;
+    }
+
+    QWidget *view;
+    if (backend == RenderBackend::OpenGL)
+    {
+        m_glView = new GLVideoWidget(this);
+        connect(m_glView, &GLVideoWidget::glUnavailable,
+                this, &TMyVideoWidget::onGlUnavailable);
+        view = m_glView;
+    }
+    else if (backend == RenderBackend::SDL)
+    {
+        m_sdlView = new SdlVideoWidget(this);
+        connect(m_sdlView, &SdlVideoWidget::sdlUnavailable,
+                this, &TMyVideoWidget::onSdlUnavailable);
+        view = m_sdlView;
+    }
+    else
+    {
+        m_rasterView = new RasterVideoWidget(this);
+        view = m_rasterView;
+    }
+    //鼠标事件仍交给本控件处理（单击暂停）
+    view->setAttribute(Qt::WA_TransparentForMouseEvents);
+    view->setGeometry(rect());
+    view->show();
+
+    m_renderBackend = backend;
+    emit outputFormatChanged(backend != RenderBackend::Raster
+                             ? FFmpegProcessor::OutputFormat::YUV
+                             : FFmpegProcessor::OutputFormat::RGB32);
+}
+
+void TMyVideoWidget::onGlUnavailable()
+{//着色器或上下文初始化失败，回退到 Raster
+    if (m_renderBackend == RenderBackend::OpenGL)
+        createFrameView(RenderBackend::Raster);
+}
+
+void TMyVideoWidget::onSdlUnavailable()
+{//SDL 渲染器创建失败，回退到 Raster
+    if (m_renderBackend == RenderBackend::SDL)
+        createFrameView(RenderBackend::Raster);
+}
+
+void TMyVideoWidget::setFrameMailbox(FrameMailbox *mailbox)
+{//设置帧信箱
+    if (m_mailbox)
+        disconnect(m_mailbox, nullptr, this, nullptr);
+    m_mailbox = mailbox;
+    if (m_mailbox) {
+        connect(m_mailbox, &FrameMailbox::frameAvailable,
+                this, &TMyVideoWidget::onFrameAvailable, Qt::QueuedConnection);
+        onFrameAvailable();
+    }
+}
+
+void TMyVideoWidget::onFrameAvailable()
+{//取信箱中最新的帧，通知发出后被替换的帧不会再显示
+    VideoFrame frame;
+    if (m_mailbox && m_mailbox->take(&frame))
+        presentFrame(frame);
+}
+
+void TMyVideoWidget::presentFrame(const VideoFrame &frame)
+{//显示 FFmpeg 解码帧
+    if (m_glView)
+        m_glView->presentFrame(frame);
+    else if (m_sdlView)
+        m_sdlView->presentFrame(frame);
+    else if (m_rasterView)
+        m_rasterView->presentFrame(frame);
+}
@@ -5,22 +5,67 @@
 #include <QWidget>
 #include <QMediaPlayer>
 #include <QVideoWidget>
+#include "ffmpegprocessor.h"
+
+class FrameMailbox;
+class GLVideoWidget;
+class RasterVideoWidget;
+class SdlVideoWidget;
 
 class TMyVideoWidget : public QVideoWidget
 {
     Q_OBJECT
+public:
+    // FFmpeg 解码帧的渲染方式
+    enum class RenderBackend {
+        Raster,     // QPainter 绘制 RGB32
+        OpenGL,     // 上传 YUV 平面，着色器转换颜色
+        SDL         // SDL_Renderer 绘制到原生子窗口
+    };
+
 private:
     QMediaPlayer *m_player;
 
+    FrameMailbox *m_mailbox;
+    RenderBackend m_renderBackend;
+    GLVideoWidget *m_glView;
+    RasterVideoWidget *m_rasterView;
+    SdlVideoWidget *m_sdlView;
+
+    void createFrameView(RenderBackend backend);
+
+private slots:
+    void onGlUnavailable();
+    void onSdlUnavailable();
+    void onFrameAvailable();
+
 protected:
     void keyPressEvent(QKeyEvent *event);
 
     void mousePressEvent(QMouseEvent *event);
 
+    void resizeEvent(QResizeEvent *event);
+
+signals:
+    // 显示区域变化，解码端据此直接缩放到显示尺寸
+    void viewportSizeChanged(const QSize &size, qreal devicePixelRatio);
+    // 渲染方式决定解码端应输出的格式（OpenGL/SDL 为 YUV，否则为 RGB32）
+    void outputFormatChanged(FFmpegProcessor::OutputFormat format);
+
 public:
     TMyVideoWidget(QWidget *parent =nullptr);
 
     void setMediaPlayer(QMediaPlayer *player);
+
+    // 启用 FFmpeg 帧渲染，请求 OpenGL/SDL 但不可用时自动回退到 Raster
+    void setRenderBackend(RenderBackend backend);
+    RenderBackend renderBackend() const;
+
+    // 从帧信箱取帧显示：每次通知只取最新的一帧，显示端卡顿时旧帧被替换而不是排队
+    void setFrameMailbox(FrameMailbox *mailbox);
+
+public slots:
+    void presentFrame(const VideoFrame &frame);
 };
 
 #endif // TMYVIDEOWIDGET_H
@@ -0,0 +1,98 @@
+#include "videoframe.h"
+
+static void freeAVFrame(AVFrame *frame)
+{
+    av_frame_free(&frame);
+}
+
+// QImage 销毁时释放对应的帧引用
+static void releaseImageFrame(void *info)
+{
+    AVFrame *frame = static_cast<AVFrame *>(info);
+    av_frame_free(&frame);
+}
+
+VideoFrame::VideoFrame()
+{
+}
+
+VideoFrame::VideoFrame(const AVFrame *frame)
+{
+    if (frame && frame->buf[0]) {
+        AVFrame *ref = av_frame_clone(frame);
+        if (ref) {
+            m_frame = QSharedPointer<AVFrame>(ref, freeAVFrame);
+        }
+    }
+}
+
+bool VideoFrame::isNull() const
+{
+    return !m_frame || !m_frame->data[0];
+}
+
+int VideoFrame::width() const
+{
+    return m_frame ? m_frame->width : 0;
+}
+
+int VideoFrame::height() const
+{
+    return m_frame ? m_frame->height : 0;
+}
+
+AVPixelFormat VideoFrame::format() const
+{
+    return m_frame ? static_cast<AVPixelFormat>(m_frame->format) : AV_PIX_FMT_NONE;
+}
+
+const AVFrame *VideoFrame::avFrame() const
+{
+    return m_frame.data();
+}
+
+QImage VideoFrame::toImage() const
+{
+    if (isNull()) {
+        return QImage();
+    }
+
+    QImage::Format imgFormat = imageFormat(format());
+    if (imgFormat == QImage::Format_Invalid) {
+        return QImage();
+    }
+
+    AVFrame *ref = av_frame_clone(m_frame.data());
+    if (!ref) {
+        return QImage();
+    }
+
+    return QImage(ref->data[0], ref->width, ref->height, ref->linesize[0],
+                  imgFormat, releaseImageFrame, ref);
+}
+
+QImage::Format VideoFrame::imageFormat(AVPixelFormat format)
+{
+    switch (format) {
+    case AV_PIX_FMT_RGB24:
+        return QImage::Format_RGB888;
+    case AV_PIX_FMT_RGBA:
+        return QImage::Format_RGBA8888;
+    case AV_PIX_FMT_RGB0:
+        return QImage::Format_RGBX8888;
+    // 解码输出不透明，带 alpha 的格式直接按预乘格式交给光栅引擎
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    case AV_PIX_FMT_BGRA:
+        return QImage::Format_ARGB32_Premultiplied;
+    case AV_PIX_FMT_BGR0:
+        return QImage::Format_RGB32;
+#else
+    case AV_PIX_FMT_ARGB:
+        return QImage::Format_ARGB32_Premultiplied;
+    case AV_PIX_FMT_0RGB:
+        return QImage::Format_RGB32;
+#endif
+    default:
+        return QImage::Format_Invalid;
+    }
+}
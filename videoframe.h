@@ -0,0 +1,38 @@
+#ifndef VIDEOFRAME_H
+#define VIDEOFRAME_H
+
+#include <QImage>
+#include <QMetaType>
+#include <QSharedPointer>
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+// 引用计数的视频帧句柄，底层是 AVFrame/AVBufferRef
+// 拷贝只增加引用计数，可以直接跨线程经由排队连接传递
+class VideoFrame
+{
+public:
+    VideoFrame();
+    // 引用 frame 的缓冲区，不复制像素数据
+    explicit VideoFrame(const AVFrame *frame);
+
+    bool isNull() const;
+    int width() const;
+    int height() const;
+    AVPixelFormat format() const;
+    const AVFrame *avFrame() const;
+
+    // 在显示时包装为 QImage 视图，QImage 存活期间持有缓冲区引用
+    QImage toImage() const;
+
+    static QImage::Format imageFormat(AVPixelFormat format);
+
+private:
+    QSharedPointer<AVFrame> m_frame;
+};
+
+Q_DECLARE_METATYPE(VideoFrame)
+
+#endif // VIDEOFRAME_H
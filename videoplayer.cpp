@@ -4,99 +4,252 @@
 VideoPlayer::VideoPlayer(QObject *parent)
     : QThread(parent),
       m_processor(new FFmpegProcessor()),
-      m_stopRequested(false),
-      m_pauseRequested(false),
-      m_seekPosition(-1)
+      m_exiting(false),
+      m_opened(false),
+      m_paused(false)
 {
+    qRegisterMetaType<VideoPlayer::Command>("VideoPlayer::Command");
+    m_commandTimer.start();
+
     // 连接FFmpegProcessor的信号
-    connect(m_processor, &FFmpegProcessor::frameReady,
-            this, &VideoPlayer::frameReady);
     connect(m_processor, &FFmpegProcessor::statusChanged,
             this, &VideoPlayer::statusChanged);
     connect(m_processor, &FFmpegProcessor::errorOccurred,
             this, &VideoPlayer::errorOccurred);
+    connect(m_processor, &FFmpegProcessor::seekFinished,
+            this, &VideoPlayer::seekFinished);
 }
 
 VideoPlayer::~VideoPlayer()
 {
-    stopPlayback();
-    quit();
+    {
+        QMutexLocker locker(&m_mutex);
+        m_exiting = true;
+        m_processor->interrupt();
+        m_commandReady.wakeAll();
+    }
     wait();
     delete m_processor;
 }
 
 void VideoPlayer::play(const QString &url)
 {
-    QMutexLocker locker(&m_mutex);
-    m_url = url;
-    m_stopRequested = false;
-    m_pauseRequested = false;
-    m_seekPosition = -1;
+    PendingCommand command;
+    command.type = Command::Play;
+    command.url = url;
+    post(command);
 
     if (!isRunning()) {
         start();
-    } else {
-        // 如果已经在运行，重新打开流
-        m_processor->openStream(url);
     }
 }
 
 void VideoPlayer::pausePlayback()
 {
-    QMutexLocker locker(&m_mutex);
-    m_pauseRequested = true;
+    PendingCommand command;
+    command.type = Command::Pause;
+    post(command);
 }
 
 void VideoPlayer::resumePlayback()
 {
-    QMutexLocker locker(&m_mutex);
-    m_pauseRequested = false;
+    PendingCommand command;
+    command.type = Command::Resume;
+    post(command);
 }
 
 void VideoPlayer::stopPlayback()
+{
+    PendingCommand command;
+    command.type = Command::Stop;
+    post(command);
+}
+
+void VideoPlayer::seek(int position, bool accurate)
+{
+    PendingCommand command;
+    command.type = Command::Seek;
+    command.position = position;
+    command.accurate = accurate;
+    post(command);
+}
+
+void VideoPlayer::setOutputSize(const QSize &size, qreal devicePixelRatio)
+{
+    PendingCommand command;
+    command.type = Command::SetOutputSize;
+    command.size = size;
+    command.devicePixelRatio = devicePixelRatio;
+    post(command);
+}
+
+void VideoPlayer::setOutputFormat(FFmpegProcessor::OutputFormat format)
+{
+    PendingCommand command;
+    command.type = Command::SetOutputFormat;
+    command.format = format;
+    post(command);
+}
+
+FrameMailbox *VideoPlayer::frameMailbox() const
+{
+    return m_processor->frameMailbox();
+}
+
+VideoPlayer::ControlStats VideoPlayer::getControlStats() const
 {
     QMutexLocker locker(&m_mutex);
-    m_stopRequested = true;
+    return m_controlStats;
 }
 
-void VideoPlayer::seek(int position)
+void VideoPlayer::post(PendingCommand command)
 {
     QMutexLocker locker(&m_mutex);
-    m_seekPosition = position;
+    command.postedNs = m_commandTimer.nsecsElapsed();
+    m_commands.enqueue(command);
+
+    // 切换和停止要让阻塞中的网络读取立即返回；中断标志是原子量，可以在调用方线程设置
+    if (command.type == Command::Play || command.type == Command::Stop) {
+        m_processor->interrupt();
+    }
+    m_commandReady.wakeOne();
 }
 
-void VideoPlayer::run()
+bool VideoPlayer::isSupersededLocked() const
 {
-    if (!m_processor->openStream(m_url)) {
-        emit errorOccurred(m_processor->getErrorString());
-        return;
+    for (const PendingCommand &command : m_commands) {
+        if (command.type == Command::Play || command.type == Command::Stop) {
+            return true;
+        }
     }
+    return false;
+}
+
+void VideoPlayer::recordLatency(const PendingCommand &command)
+{
+    double latency = (m_commandTimer.nsecsElapsed() - command.postedNs) / 1e6;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_controlStats.commands++;
+        m_controlStats.lastLatency = latency;
+        m_controlStats.maxLatency = qMax(m_controlStats.maxLatency, latency);
+        m_controlStats.avgLatency += (latency - m_controlStats.avgLatency) / qMin<qint64>(m_controlStats.commands, 32);
+    }
+    emit commandApplied(command.type, latency);
+}
 
-    while (!m_stopRequested) {
+bool VideoPlayer::execute(const PendingCommand &command)
+{
+    switch (command.type) {
+    case Command::Play: {
+        // 旧流在中断状态下关闭，不会等待网络
+        m_processor->closeStream();
+        m_opened = false;
+        m_paused = false;
         {
             QMutexLocker locker(&m_mutex);
+            // 队列中已有新的切换或停止，放弃本次打开
+            if (isSupersededLocked() || m_exiting) {
+                return !m_exiting;
+            }
+            m_processor->clearInterrupt();
+        }
 
-            if (m_pauseRequested) {
-                m_processor->pause();
-                QThread::msleep(100); // 暂停时降低CPU使用率
-                continue;
-            } else {
-                m_processor->resume();
+        if (!m_processor->openStream(command.url)) {
+            if (!m_processor->isInterrupted()) {
+                emit errorOccurred(m_processor->getErrorString());
             }
+            return true;
+        }
+        m_opened = true;
 
-            if (m_seekPosition >= 0) {
-                m_processor->seek(m_seekPosition / 1000.0);
-                m_seekPosition = -1;
+        double latency = (m_commandTimer.nsecsElapsed() - command.postedNs) / 1e6;
+        qDebug() << "切换流:" << command.url << latency << "ms";
+        emit streamOpened(command.url, latency);
+        break;
+    }
+    case Command::Pause:
+        m_paused = true;
+        m_processor->pause();
+        break;
+    case Command::Resume:
+        m_paused = false;
+        m_processor->resume();
+        break;
+    case Command::Seek:
+        if (!m_opened) {
+            return true;
+        }
+        m_processor->setSeekMode(command.accurate ? FFmpegProcessor::SeekMode::Accurate
+                                                  : FFmpegProcessor::SeekMode::Keyframe);
+        m_processor->seek(command.position / 1000.0);
+        break;
+    case Command::Stop:
+        m_processor->closeStream();
+        m_opened = false;
+        m_paused = false;
+        break;
+    case Command::SetOutputSize:
+        m_processor->setOutputSize(command.size, command.devicePixelRatio);
+        break;
+    case Command::SetOutputFormat:
+        m_processor->setOutputFormat(command.format);
+        break;
+    }
+
+    recordLatency(command);
+    return true;
+}
+
+void VideoPlayer::run()
+{
+    for (;;) {
+        PendingCommand command;
+        bool hasCommand = false;
+        {
+            QMutexLocker locker(&m_mutex);
+            // 暂停、未打开或读到流末尾时没有事可做，等待下一条命令
+            while (!m_exiting && m_commands.isEmpty()
+                   && (!m_opened || m_paused || m_processor->isEndOfStream())) {
+                m_commandReady.wait(&m_mutex);
+            }
+            if (m_exiting) {
+                break;
+            }
+            if (!m_commands.isEmpty()) {
+                command = m_commands.dequeue();
+                // 连续的跳转只执行最后一个
+                while (command.type == Command::Seek && !m_commands.isEmpty()
+                       && m_commands.head().type == Command::Seek) {
+                    command = m_commands.dequeue();
+                }
+                hasCommand = true;
+            }
+        }
+
+        if (hasCommand) {
+            if (!execute(command)) {
+                break;
             }
+            continue;
         }
 
+        // 本线程只负责解复用，解码在 FFmpegProcessor 的解码线程中进行
         if (!m_processor->readFrame()) {
-            // 读取失败或流结束
+            if (m_processor->isInterrupted() || m_processor->isEndOfStream()) {
+                continue;
+            }
             if (m_processor->getStatus() == FFmpegProcessor::StreamStatus::Error) {
                 emit errorOccurred(m_processor->getErrorString());
-                break;
+                m_processor->closeStream();
+                m_opened = false;
+                continue;
+            }
+            // 暂时没有数据（EAGAIN 等），短暂等待，新命令到达时立即唤醒
+            QMutexLocker locker(&m_mutex);
+            if (m_commands.isEmpty() && !m_exiting) {
+                m_commandReady.wait(&m_mutex, 10);
             }
-            QThread::msleep(10); // 短暂休眠避免CPU占用过高
         }
     }
 
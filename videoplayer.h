@@ -3,12 +3,35 @@
 
 #include <QThread>
 #include <QImage>
+#include <QElapsedTimer>
+#include <QQueue>
+#include <QWaitCondition>
 #include "ffmpegprocessor.h"
 
+// 播放线程：所有控制操作以命令的形式排队，由本线程按顺序执行，调用方线程不直接操作 FFmpegProcessor
+// 没有命令且无需读包（暂停、未打开、流末尾）时在条件变量上等待，新命令立即唤醒
 class VideoPlayer : public QThread
 {
     Q_OBJECT
 public:
+    enum class Command {
+        Play,       // 打开 URL，运行中即切换流
+        Pause,
+        Resume,
+        Seek,
+        Stop,
+        SetOutputSize,
+        SetOutputFormat
+    };
+
+    // 控制延迟：命令入队到生效的时间（毫秒），Play 以打开完成为生效
+    struct ControlStats {
+        qint64 commands = 0;
+        double lastLatency = 0.0;
+        double avgLatency = 0.0;
+        double maxLatency = 0.0;
+    };
+
     explicit VideoPlayer(QObject *parent = nullptr);
     ~VideoPlayer();
 
@@ -16,23 +39,59 @@ public:
     void pausePlayback();
     void resumePlayback();
     void stopPlayback();
-    void seek(int position);
+    // position 为毫秒，accurate 为 false 时只跳到关键帧（拖动预览）
+    void seek(int position, bool accurate = true);
+    void setOutputSize(const QSize &size, qreal devicePixelRatio);
+    void setOutputFormat(FFmpegProcessor::OutputFormat format);
+
+    ControlStats getControlStats() const;
+    // 解码帧信箱，可在任意线程读取
+    FrameMailbox *frameMailbox() const;
 
 signals:
-    void frameReady(const QImage &frame);
     void statusChanged(int status);
     void errorOccurred(const QString &errorMessage);
+    void seekFinished(double position, double latencyMs);
+    // 新流打开完成，switchLatency 为调用 play 到打开完成的时间（毫秒）
+    void streamOpened(const QString &url, double switchLatency);
+    void commandApplied(VideoPlayer::Command command, double latencyMs);
 
 protected:
     void run() override;
 
 private:
+    struct PendingCommand {
+        Command type;
+        QString url;
+        qint64 position = -1;
+        bool accurate = true;
+        QSize size;
+        qreal devicePixelRatio = 1.0;
+        FFmpegProcessor::OutputFormat format = FFmpegProcessor::OutputFormat::RGB32;
+        qint64 postedNs = 0;
+    };
+
+    void post(PendingCommand command);
+    // 返回 false 表示应退出线程
+    bool execute(const PendingCommand &command);
+    void recordLatency(const PendingCommand &command);
+    // 队列中是否有更新的 Play/Stop，使当前 Play 失去意义
+    bool isSupersededLocked() const;
+
     FFmpegProcessor *m_processor;
-    QString m_url;
-    bool m_stopRequested;
-    bool m_pauseRequested;
-    qint64 m_seekPosition;
-    QMutex m_mutex;
+    QQueue<PendingCommand> m_commands;
+    QWaitCondition m_commandReady;
+    bool m_exiting;
+    QElapsedTimer m_commandTimer;
+
+    // 以下只在播放线程中访问
+    bool m_opened;
+    bool m_paused;
+
+    ControlStats m_controlStats;
+    mutable QMutex m_mutex;
 };
 
+Q_DECLARE_METATYPE(VideoPlayer::Command)
+
 #endif // VIDEOPLAYER_H
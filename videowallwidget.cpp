@@ -0,0 +1,343 @@
+#include "videowallwidget.h"
+#include "ffmpegprocessor.h"
+#include "framemailbox.h"
+#include "streamscheduler.h"
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPaintEvent>
+#include <cmath>
+
+// 格子之间的间隔（逻辑像素）
+static const int kTileSpacing = 2;
+
+VideoWallWidget::VideoWallWidget(QWidget *parent)
+    : QWidget(parent),
+      m_scheduler(new StreamScheduler(0, this)),
+      m_columns(0),
+      m_currentTile(-1),
+      m_maximizedTile(-1)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setFocusPolicy(Qt::StrongFocus);
+
+    connect(m_scheduler, &StreamScheduler::streamOpened, this, &VideoWallWidget::onStreamOpened, Qt::QueuedConnection);
+}
+
+VideoWallWidget::~VideoWallWidget()
+{
+    clear();
+}
+
+int VideoWallWidget::addStream(const QString &url)
+{
+    Tile *tile = new Tile;
+    tile->url = url;
+    tile->processor = new FFmpegProcessor(this);
+    tile->processor->setAudioEnabled(false);
+
+    // 以 processor 为上下文，移除格子后尚未处理的通知一并丢弃
+    FFmpegProcessor *processor = tile->processor;
+    connect(processor->frameMailbox(), &FrameMailbox::frameAvailable, processor, [this, processor]() {
+        onFrameAvailable(processor);
+    }, Qt::QueuedConnection);
+
+    m_tiles.append(tile);
+    m_scheduler->addStream(processor, url);
+    if (m_currentTile < 0) {
+        m_currentTile = 0;
+        emit currentTileChanged(m_currentTile);
+    }
+    layoutTiles();
+    return m_tiles.size() - 1;
+}
+
+void VideoWallWidget::removeStream(int index)
+{
+    if (index < 0 || index >= m_tiles.size()) {
+        return;
+    }
+
+    Tile *tile = m_tiles.takeAt(index);
+    m_scheduler->removeStream(tile->processor);
+    delete tile->processor;
+    delete tile;
+
+    if (m_maximizedTile == index) {
+        m_maximizedTile = -1;
+        emit maximizedTileChanged(-1);
+    } else if (m_maximizedTile > index) {
+        m_maximizedTile--;
+    }
+    // 移除当前格子时由后一个格子接替（移除的是最后一个时取前一个），序号不变也要通知
+    if (m_currentTile == index) {
+        m_currentTile = m_tiles.isEmpty() ? -1 : qMin(index, m_tiles.size() - 1);
+        emit currentTileChanged(m_currentTile);
+    } else if (m_currentTile > index) {
+        m_currentTile--;
+        emit currentTileChanged(m_currentTile);
+    }
+    layoutTiles();
+}
+
+void VideoWallWidget::clear()
+{
+    while (!m_tiles.isEmpty()) {
+        removeStream(m_tiles.size() - 1);
+    }
+}
+
+int VideoWallWidget::count() const
+{
+    return m_tiles.size();
+}
+
+QString VideoWallWidget::url(int index) const
+{
+    return index >= 0 && index < m_tiles.size() ? m_tiles[index]->url : QString();
+}
+
+void VideoWallWidget::setColumns(int columns)
+{
+    m_columns = qMax(0, columns);
+    layoutTiles();
+}
+
+int VideoWallWidget::columns() const
+{
+    return m_columns;
+}
+
+void VideoWallWidget::setMaximizedTile(int index)
+{
+    if (index >= m_tiles.size()) {
+        index = -1;
+    }
+    if (index == m_maximizedTile) {
+        return;
+    }
+
+    m_maximizedTile = index;
+    if (index >= 0) {
+        setCurrentTile(index);
+    }
+    layoutTiles();
+    emit maximizedTileChanged(index);
+}
+
+int VideoWallWidget::maximizedTile() const
+{
+    return m_maximizedTile;
+}
+
+void VideoWallWidget::setCurrentTile(int index)
+{
+    if (index < 0 || index >= m_tiles.size() || index == m_currentTile) {
+        return;
+    }
+
+    int previous = m_currentTile;
+    m_currentTile = index;
+    if (previous >= 0 && previous < m_tiles.size()) {
+        updateTileDecode(previous);
+        update(m_tiles[previous]->rect);
+    }
+    updateTileDecode(index);
+    update(m_tiles[index]->rect);
+    emit currentTileChanged(index);
+}
+
+int VideoWallWidget::currentTile() const
+{
+    return m_currentTile;
+}
+
+StreamScheduler *VideoWallWidget::scheduler() const
+{
+    return m_scheduler;
+}
+
+void VideoWallWidget::paintEvent(QPaintEvent *event)
+{
+    // 只重绘有新帧的格子，Qt 会把同一轮事件中的多个区域合并成一次绘制
+    QPainter painter(this);
+    painter.fillRect(event->rect(), Qt::black);
+
+    for (int i = 0; i < m_tiles.size(); i++) {
+        const Tile *tile = m_tiles[i];
+        if (tile->rect.isEmpty() || !event->rect().intersects(tile->rect)) {
+            continue;
+        }
+
+        // 解码端已经缩放到格子尺寸，这里只按宽高比居中
+        QImage image = tile->frame.toImage();
+        if (!image.isNull()) {
+            QSize fitted = image.size().scaled(tile->rect.size(), Qt::KeepAspectRatio);
+            QRect target(tile->rect.x() + (tile->rect.width() - fitted.width()) / 2,
+                         tile->rect.y() + (tile->rect.height() - fitted.height()) / 2,
+                         fitted.width(), fitted.height());
+            painter.drawImage(target, image);
+        } else if (!tile->error.isEmpty()) {
+            painter.setPen(Qt::gray);
+            painter.drawText(tile->rect, Qt::AlignCenter | Qt::TextWordWrap, tile->error);
+        }
+
+        if (i == m_currentTile && m_maximizedTile < 0 && m_tiles.size() > 1) {
+            painter.setPen(QPen(Qt::yellow, 2));
+            painter.drawRect(tile->rect.adjusted(1, 1, -1, -1));
+        }
+    }
+}
+
+void VideoWallWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    layoutTiles();
+}
+
+void VideoWallWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton) {
+        setCurrentTile(tileAt(event->pos()));
+    }
+    QWidget::mousePressEvent(event);
+}
+
+void VideoWallWidget::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton) {
+        int index = tileAt(event->pos());
+        setMaximizedTile(m_maximizedTile >= 0 ? -1 : index);
+    }
+    QWidget::mouseDoubleClickEvent(event);
+}
+
+void VideoWallWidget::keyPressEvent(QKeyEvent *event)
+{
+    if (event->key() == Qt::Key_Escape && m_maximizedTile >= 0) {
+        setMaximizedTile(-1);
+        event->accept();
+        return;
+    }
+    QWidget::keyPressEvent(event);
+}
+
+int VideoWallWidget::tileAt(const QPoint &pos) const
+{
+    for (int i = 0; i < m_tiles.size(); i++) {
+        if (m_tiles[i]->rect.contains(pos)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int VideoWallWidget::indexOf(FFmpegProcessor *processor) const
+{
+    for (int i = 0; i < m_tiles.size(); i++) {
+        if (m_tiles[i]->processor == processor) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 计算各格子位置，最大化时只有一个格子占满整个区域
+void VideoWallWidget::layoutTiles()
+{
+    int count = m_tiles.size();
+    if (count > 0) {
+        int columns = m_columns > 0 ? qMin(m_columns, count) : static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+        int rows = (count + columns - 1) / columns;
+        int cellWidth = qMax(1, (width() - kTileSpacing * (columns - 1)) / columns);
+        int cellHeight = qMax(1, (height() - kTileSpacing * (rows - 1)) / rows);
+
+        for (int i = 0; i < count; i++) {
+            if (m_maximizedTile >= 0) {
+                m_tiles[i]->rect = i == m_maximizedTile ? rect() : QRect();
+            } else {
+                int row = i / columns;
+                int column = i % columns;
+                m_tiles[i]->rect = QRect(column * (cellWidth + kTileSpacing), row * (cellHeight + kTileSpacing),
+                                         cellWidth, cellHeight);
+            }
+            updateTileDecode(i);
+        }
+    }
+    update();
+}
+
+// 按格子在屏幕上的像素尺寸决定解码方式
+void VideoWallWidget::updateTileDecode(int index)
+{
+    Tile *tile = m_tiles[index];
+    FFmpegProcessor::StreamInfo info = tile->processor->getStreamInfo();
+    QSize source(info.videoWidth, info.videoHeight);
+    qreal ratio = devicePixelRatioF();
+
+    StreamScheduler::Priority priority = StreamScheduler::Priority::Normal;
+    int lowres = 0;
+    if (index == m_maximizedTile) {
+        // 最大化：全分辨率、全帧率
+        priority = StreamScheduler::Priority::Focused;
+    } else if (tile->rect.isEmpty()) {
+        // 被最大化的格子遮住：保持连接，以最低代价解码
+        priority = StreamScheduler::Priority::Background;
+        lowres = 3;
+    } else {
+        QSize device(qRound(tile->rect.width() * ratio), qRound(tile->rect.height() * ratio));
+        lowres = lowresLevel(source, device);
+        // 当前格子保持全帧率，其余远小于原始分辨率的格子降到后台
+        if (index != m_currentTile && !source.isEmpty() && device.height() * 2 <= source.height()) {
+            priority = StreamScheduler::Priority::Background;
+        }
+    }
+
+    tile->processor->setLowres(lowres);
+    if (!tile->rect.isEmpty()) {
+        tile->processor->setOutputSize(tile->rect.size(), ratio);
+    }
+    m_scheduler->setPriority(tile->processor, priority);
+}
+
+// 每级宽高减半，取缩小后仍不小于显示尺寸的最大级别
+int VideoWallWidget::lowresLevel(const QSize &source, const QSize &target)
+{
+    if (source.isEmpty() || target.isEmpty()) {
+        return 0;
+    }
+
+    int level = 0;
+    while (level < 3 && (source.width() >> (level + 1)) >= target.width()
+           && (source.height() >> (level + 1)) >= target.height()) {
+        level++;
+    }
+    return level;
+}
+
+void VideoWallWidget::onFrameAvailable(FFmpegProcessor *processor)
+{
+    int index = indexOf(processor);
+    if (index < 0) {
+        return;
+    }
+
+    Tile *tile = m_tiles[index];
+    if (processor->frameMailbox()->take(&tile->frame) && !tile->rect.isEmpty()) {
+        update(tile->rect);
+    }
+}
+
+void VideoWallWidget::onStreamOpened(FFmpegProcessor *processor, bool ok)
+{
+    int index = indexOf(processor);
+    if (index < 0) {
+        return;
+    }
+
+    // 打开后才知道原始分辨率，重新选择解码方式
+    Tile *tile = m_tiles[index];
+    tile->error = ok ? QString() : processor->getErrorString();
+    updateTileDecode(index);
+    update(tile->rect);
+}
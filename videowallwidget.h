@@ -0,0 +1,77 @@
+#ifndef VIDEOWALLWIDGET_H
+#define VIDEOWALLWIDGET_H
+
+#include <QWidget>
+#include <QVector>
+#include "videoframe.h"
+
+class FFmpegProcessor;
+class StreamScheduler;
+
+// 多画面：N 路流按网格排列，所有格子在同一个 paintEvent 中绘制到一个表面上
+// 解码由共享的 StreamScheduler 驱动；格子越小解码越省：解码器支持时用 lowres，
+// 画面远小于原始分辨率时跳过非参考帧并降帧率，输出直接缩放到格子尺寸
+// 双击最大化一个格子，该路恢复全分辨率、全帧率解码，其余各路降到后台
+class VideoWallWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit VideoWallWidget(QWidget *parent = nullptr);
+    ~VideoWallWidget();
+
+    // 加入一路流（不解码音频），返回格子序号
+    int addStream(const QString &url);
+    void removeStream(int index);
+    void clear();
+    int count() const;
+    QString url(int index) const;
+
+    // 列数，0 表示按数量自动取接近正方形的布局
+    void setColumns(int columns);
+    int columns() const;
+
+    // 最大化一个格子，-1 恢复网格
+    void setMaximizedTile(int index);
+    int maximizedTile() const;
+    void setCurrentTile(int index);
+    int currentTile() const;
+
+    StreamScheduler *scheduler() const;
+
+signals:
+    void currentTileChanged(int index);
+    void maximizedTileChanged(int index);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+
+private:
+    struct Tile {
+        FFmpegProcessor *processor = nullptr;
+        QString url;
+        VideoFrame frame;
+        QRect rect;
+        QString error;
+    };
+
+    int tileAt(const QPoint &pos) const;
+    int indexOf(FFmpegProcessor *processor) const;
+    void layoutTiles();
+    void updateTileDecode(int index);
+    static int lowresLevel(const QSize &source, const QSize &target);
+    void onFrameAvailable(FFmpegProcessor *processor);
+    void onStreamOpened(FFmpegProcessor *processor, bool ok);
+
+    StreamScheduler *m_scheduler;
+    QVector<Tile *> m_tiles;
+    int m_columns;
+    int m_currentTile;
+    int m_maximizedTile;
+};
+
+#endif // VIDEOWALLWIDGET_H
@@ -0,0 +1,557 @@
+#include "yuvconvert.h"
+
+#include <cmath>
+#include <cstdint>
+
+extern "C" {
+#include <libavutil/cpu.h>
+}
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define YUV_HAVE_X86 1
+#include <immintrin.h>
+#else
+#define YUV_HAVE_X86 0
+#endif
+
+// GCC/Clang(MinGW) 需要按函数开启指令集，MSVC 直接可用
+#if YUV_HAVE_X86 && (defined(__GNUC__) || defined(__clang__))
+#define YUV_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define YUV_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define YUV_TARGET_SSE41
+#define YUV_TARGET_AVX2
+#endif
+
+namespace {
+
+enum class SrcLayout {
+    I420,   // yuv420p / yuvj420p
+    NV12,
+    I010    // yuv420p10le
+};
+
+enum class DstLayout {
+    Bgra,   // 内存顺序 B G R A，即小端下的 QImage::Format_RGB32/ARGB32
+    Rgba    // 内存顺序 R G B A，即 QImage::Format_RGBX8888/RGBA8888
+};
+
+// 定点系数，所有内核共用同一套整数运算：
+//   luma   = mulhrs((Y - yOffset) << lumaShift, cy)
+//   chroma = mulhrs((C - uvOffset) << chromaShift, k)
+//   out    = ((luma + chroma) + 32) >> 6（16 位饱和加法），再饱和到 0..255
+// cy 为 Q14，色度系数为 Q13，中间结果带 6 位小数
+struct Coefficients {
+    int16_t yOffset;
+    int16_t uvOffset;
+    int16_t cy;
+    int16_t crv;
+    int16_t cgu;
+    int16_t cgv;
+    int16_t cbu;
+};
+
+template<SrcLayout S> struct Layout;
+
+template<> struct Layout<SrcLayout::I420> {
+    static const int lumaShift = 7;
+    static const int chromaShift = 8;
+    static const int bitDepth = 8;
+    static int y(const uint8_t *yRow, int x) { return yRow[x]; }
+    static int u(const uint8_t *uRow, const uint8_t *, int x) { return uRow[x >> 1]; }
+    static int v(const uint8_t *, const uint8_t *vRow, int x) { return vRow[x >> 1]; }
+};
+
+template<> struct Layout<SrcLayout::NV12> {
+    static const int lumaShift = 7;
+    static const int chromaShift = 8;
+    static const int bitDepth = 8;
+    static int y(const uint8_t *yRow, int x) { return yRow[x]; }
+    static int u(const uint8_t *uvRow, const uint8_t *, int x) { return uvRow[(x >> 1) * 2]; }
+    static int v(const uint8_t *uvRow, const uint8_t *, int x) { return uvRow[(x >> 1) * 2 + 1]; }
+};
+
+template<> struct Layout<SrcLayout::I010> {
+    static const int lumaShift = 5;
+    static const int chromaShift = 6;
+    static const int bitDepth = 10;
+    static int y(const uint8_t *yRow, int x) { return reinterpret_cast<const uint16_t *>(yRow)[x]; }
+    static int u(const uint8_t *uRow, const uint8_t *, int x) { return reinterpret_cast<const uint16_t *>(uRow)[x >> 1]; }
+    static int v(const uint8_t *, const uint8_t *vRow, int x) { return reinterpret_cast<const uint16_t *>(vRow)[x >> 1]; }
+};
+
+Coefficients makeCoefficients(int bitDepth, bool bt709, bool fullRange)
+{
+    double kr = bt709 ? 0.2126 : 0.299;
+    double kb = bt709 ? 0.0722 : 0.114;
+    double kg = 1.0 - kr - kb;
+
+    double yScale = fullRange ? 1.0 : 255.0 / 219.0;
+    double cScale = fullRange ? 1.0 : 255.0 / 224.0;
+
+    Coefficients c;
+    c.yOffset = static_cast<int16_t>(fullRange ? 0 : 16 << (bitDepth - 8));
+    c.uvOffset = static_cast<int16_t>(128 << (bitDepth - 8));
+    c.cy = static_cast<int16_t>(std::lround(yScale * 16384.0));
+    c.crv = static_cast<int16_t>(std::lround(2.0 * (1.0 - kr) * cScale * 8192.0));
+    c.cgu = static_cast<int16_t>(std::lround(-2.0 * kb * (1.0 - kb) / kg * cScale * 8192.0));
+    c.cgv = static_cast<int16_t>(std::lround(-2.0 * kr * (1.0 - kr) / kg * cScale * 8192.0));
+    c.cbu = static_cast<int16_t>(std::lround(2.0 * (1.0 - kb) * cScale * 8192.0));
+    return c;
+}
+
+// ---------------------------------------------------------------------------
+// 标量参考实现：逐条模拟 SIMD 的 16 位运算（回绕、饱和、舍入）
+
+inline int16_t wrap16(int v)
+{
+    return static_cast<int16_t>(static_cast<uint16_t>(v));
+}
+
+inline int16_t adds16(int a, int b)
+{
+    int v = a + b;
+    return static_cast<int16_t>(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+}
+
+inline int16_t mulhrs16(int16_t a, int16_t b)
+{
+    return wrap16((static_cast<int32_t>(a) * b + 0x4000) >> 15);
+}
+
+inline uint8_t packus(int16_t v)
+{
+    return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+template<SrcLayout S, DstLayout D>
+void rowScalar(const Coefficients &c, const uint8_t *yRow, const uint8_t *uRow, const uint8_t *vRow,
+               uint8_t *dst, int x, int width)
+{
+    typedef Layout<S> L;
+
+    for (; x < width; x++) {
+        int16_t y = wrap16(wrap16(L::y(yRow, x) - c.yOffset) << L::lumaShift);
+        int16_t u = wrap16(wrap16(L::u(uRow, vRow, x) - c.uvOffset) << L::chromaShift);
+        int16_t v = wrap16(wrap16(L::v(uRow, vRow, x) - c.uvOffset) << L::chromaShift);
+
+        int16_t yt = mulhrs16(y, c.cy);
+        int16_t rt = mulhrs16(v, c.crv);
+        int16_t gt = adds16(mulhrs16(u, c.cgu), mulhrs16(v, c.cgv));
+        int16_t bt = mulhrs16(u, c.cbu);
+
+        uint8_t r = packus(static_cast<int16_t>(adds16(adds16(yt, rt), 32) >> 6));
+        uint8_t g = packus(static_cast<int16_t>(adds16(adds16(yt, gt), 32) >> 6));
+        uint8_t b = packus(static_cast<int16_t>(adds16(adds16(yt, bt), 32) >> 6));
+
+        uint8_t *p = dst + x * 4;
+        p[0] = D == DstLayout::Bgra ? b : r;
+        p[1] = g;
+        p[2] = D == DstLayout::Bgra ? r : b;
+        p[3] = 0xff;
+    }
+}
+
+#if YUV_HAVE_X86
+
+// ---------------------------------------------------------------------------
+// SSE4.1：每次 16 个像素
+
+struct SseCoefficients {
+    __m128i yOffset, uvOffset, cy, crv, cgu, cgv, cbu, round;
+};
+
+YUV_TARGET_SSE41 inline SseCoefficients loadSse(const Coefficients &c)
+{
+    SseCoefficients k;
+    k.yOffset = _mm_set1_epi16(c.yOffset);
+    k.uvOffset = _mm_set1_epi16(c.uvOffset);
+    k.cy = _mm_set1_epi16(c.cy);
+    k.crv = _mm_set1_epi16(c.crv);
+    k.cgu = _mm_set1_epi16(c.cgu);
+    k.cgv = _mm_set1_epi16(c.cgv);
+    k.cbu = _mm_set1_epi16(c.cbu);
+    k.round = _mm_set1_epi16(32);
+    return k;
+}
+
+template<SrcLayout S> struct SseLoad;
+
+template<> struct SseLoad<SrcLayout::I420> {
+    YUV_TARGET_SSE41 static inline void load(const uint8_t *y, const uint8_t *u, const uint8_t *v, int x,
+                                             __m128i &y0, __m128i &y1, __m128i &uu, __m128i &vv)
+    {
+        __m128i yy = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y + x));
+        y0 = _mm_cvtepu8_epi16(yy);
+        y1 = _mm_cvtepu8_epi16(_mm_srli_si128(yy, 8));
+        uu = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(u + x / 2)));
+        vv = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(v + x / 2)));
+    }
+};
+
+template<> struct SseLoad<SrcLayout::NV12> {
+    YUV_TARGET_SSE41 static inline void load(const uint8_t *y, const uint8_t *uv, const uint8_t *, int x,
+                                             __m128i &y0, __m128i &y1, __m128i &uu, __m128i &vv)
+    {
+        __m128i yy = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y + x));
+        y0 = _mm_cvtepu8_epi16(yy);
+        y1 = _mm_cvtepu8_epi16(_mm_srli_si128(yy, 8));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(uv + x));
+        uu = _mm_and_si128(c, _mm_set1_epi16(0x00ff));
+        vv = _mm_srli_epi16(c, 8);
+    }
+};
+
+template<> struct SseLoad<SrcLayout::I010> {
+    YUV_TARGET_SSE41 static inline void load(const uint8_t *y, const uint8_t *u, const uint8_t *v, int x,
+                                             __m128i &y0, __m128i &y1, __m128i &uu, __m128i &vv)
+    {
+        const uint16_t *y16 = reinterpret_cast<const uint16_t *>(y);
+        y0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y16 + x));
+        y1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y16 + x + 8));
+        uu = _mm_loadu_si128(reinterpret_cast<const __m128i *>(reinterpret_cast<const uint16_t *>(u) + x / 2));
+        vv = _mm_loadu_si128(reinterpret_cast<const __m128i *>(reinterpret_cast<const uint16_t *>(v) + x / 2));
+    }
+};
+
+template<int LumaShift>
+YUV_TARGET_SSE41 inline void pixelsSse(const SseCoefficients &k, __m128i y, __m128i u, __m128i v,
+                                      __m128i &r, __m128i &g, __m128i &b)
+{
+    __m128i yt = _mm_mulhrs_epi16(_mm_slli_epi16(_mm_sub_epi16(y, k.yOffset), LumaShift), k.cy);
+    __m128i rt = _mm_mulhrs_epi16(v, k.crv);
+    __m128i gt = _mm_adds_epi16(_mm_mulhrs_epi16(u, k.cgu), _mm_mulhrs_epi16(v, k.cgv));
+    __m128i bt = _mm_mulhrs_epi16(u, k.cbu);
+
+    r = _mm_srai_epi16(_mm_adds_epi16(_mm_adds_epi16(yt, rt), k.round), 6);
+    g = _mm_srai_epi16(_mm_adds_epi16(_mm_adds_epi16(yt, gt), k.round), 6);
+    b = _mm_srai_epi16(_mm_adds_epi16(_mm_adds_epi16(yt, bt), k.round), 6);
+}
+
+template<DstLayout D>
+YUV_TARGET_SSE41 inline void storeSse(uint8_t *dst, __m128i r, __m128i g, __m128i b)
+{
+    __m128i first = D == DstLayout::Bgra ? b : r;
+    __m128i third = D == DstLayout::Bgra ? r : b;
+    __m128i alpha = _mm_set1_epi8(-1);
+
+    __m128i lo01 = _mm_unpacklo_epi8(first, g);
+    __m128i hi01 = _mm_unpackhi_epi8(first, g);
+    __m128i lo23 = _mm_unpacklo_epi8(third, alpha);
+    __m128i hi23 = _mm_unpackhi_epi8(third, alpha);
+
+    __m128i *out = reinterpret_cast<__m128i *>(dst);
+    _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(lo01, lo23));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo01, lo23));
+    _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi01, hi23));
+    _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi01, hi23));
+}
+
+template<SrcLayout S, DstLayout D>
+YUV_TARGET_SSE41 void rowSse41(const Coefficients &c, const uint8_t *yRow, const uint8_t *uRow,
+                               const uint8_t *vRow, uint8_t *dst, int width)
+{
+    typedef Layout<S> L;
+    const SseCoefficients k = loadSse(c);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i y0, y1, u, v;
+        SseLoad<S>::load(yRow, uRow, vRow, x, y0, y1, u, v);
+        u = _mm_slli_epi16(_mm_sub_epi16(u, k.uvOffset), L::chromaShift);
+        v = _mm_slli_epi16(_mm_sub_epi16(v, k.uvOffset), L::chromaShift);
+
+        // 每个色度样本对应水平相邻的两个像素
+        __m128i r0, g0, b0, r1, g1, b1;
+        pixelsSse<L::lumaShift>(k, y0, _mm_unpacklo_epi16(u, u), _mm_unpacklo_epi16(v, v), r0, g0, b0);
+        pixelsSse<L::lumaShift>(k, y1, _mm_unpackhi_epi16(u, u), _mm_unpackhi_epi16(v, v), r1, g1, b1);
+
+        storeSse<D>(dst + x * 4, _mm_packus_epi16(r0, r1), _mm_packus_epi16(g0, g1), _mm_packus_epi16(b0, b1));
+    }
+
+    rowScalar<S, D>(c, yRow, uRow, vRow, dst, x, width);
+}
+
+// ---------------------------------------------------------------------------
+// AVX2：每次 32 个像素
+
+struct AvxCoefficients {
+    __m256i yOffset, uvOffset, cy, crv, cgu, cgv, cbu, round;
+};
+
+YUV_TARGET_AVX2 inline AvxCoefficients loadAvx(const Coefficients &c)
+{
+    AvxCoefficients k;
+    k.yOffset = _mm256_set1_epi16(c.yOffset);
+    k.uvOffset = _mm256_set1_epi16(c.uvOffset);
+    k.cy = _mm256_set1_epi16(c.cy);
+    k.crv = _mm256_set1_epi16(c.crv);
+    k.cgu = _mm256_set1_epi16(c.cgu);
+    k.cgv = _mm256_set1_epi16(c.cgv);
+    k.cbu = _mm256_set1_epi16(c.cbu);
+    k.round = _mm256_set1_epi16(32);
+    return k;
+}
+
+template<SrcLayout S> struct AvxLoad;
+
+template<> struct AvxLoad<SrcLayout::I420> {
+    YUV_TARGET_AVX2 static inline void load(const uint8_t *y, const uint8_t *u, const uint8_t *v, int x,
+                                            __m256i &y0, __m256i &y1, __m256i &uu, __m256i &vv)
+    {
+        y0 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(y + x)));
+        y1 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(y + x + 16)));
+        uu = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(u + x / 2)));
+        vv = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(v + x / 2)));
+    }
+};
+
+template<> struct AvxLoad<SrcLayout::NV12> {
+    YUV_TARGET_AVX2 static inline void load(const uint8_t *y, const uint8_t *uv, const uint8_t *, int x,
+                                            __m256i &y0, __m256i &y1, __m256i &uu, __m256i &vv)
+    {
+        y0 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(y + x)));
+        y1 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(y + x + 16)));
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(uv + x));
+        uu = _mm256_and_si256(c, _mm256_set1_epi16(0x00ff));
+        vv = _mm256_srli_epi16(c, 8);
+    }
+};
+
+template<> struct AvxLoad<SrcLayout::I010> {
+    YUV_TARGET_AVX2 static inline void load(const uint8_t *y, const uint8_t *u, const uint8_t *v, int x,
+                                            __m256i &y0, __m256i &y1, __m256i &uu, __m256i &vv)
+    {
+        const uint16_t *y16 = reinterpret_cast<const uint16_t *>(y);
+        y0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(y16 + x));
+        y1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(y16 + x + 16));
+        uu = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(reinterpret_cast<const uint16_t *>(u) + x / 2));
+        vv = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(reinterpret_cast<const uint16_t *>(v) + x / 2));
+    }
+};
+
+template<int LumaShift>
+YUV_TARGET_AVX2 inline void pixelsAvx(const AvxCoefficients &k, __m256i y, __m256i u, __m256i v,
+                                     __m256i &r, __m256i &g, __m256i &b)
+{
+    __m256i yt = _mm256_mulhrs_epi16(_mm256_slli_epi16(_mm256_sub_epi16(y, k.yOffset), LumaShift), k.cy);
+    __m256i rt = _mm256_mulhrs_epi16(v, k.crv);
+    __m256i gt = _mm256_adds_epi16(_mm256_mulhrs_epi16(u, k.cgu), _mm256_mulhrs_epi16(v, k.cgv));
+    __m256i bt = _mm256_mulhrs_epi16(u, k.cbu);
+
+    r = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(yt, rt), k.round), 6);
+    g = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(yt, gt), k.round), 6);
+    b = _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(yt, bt), k.round), 6);
+}
+
+// r/g/b 由 packus 得到，128 位通道内顺序为 [0-7, 16-23 | 8-15, 24-31]
+template<DstLayout D>
+YUV_TARGET_AVX2 inline void storeAvx(uint8_t *dst, __m256i r, __m256i g, __m256i b)
+{
+    __m256i first = D == DstLayout::Bgra ? b : r;
+    __m256i third = D == DstLayout::Bgra ? r : b;
+    __m256i alpha = _mm256_set1_epi8(-1);
+
+    __m256i lo01 = _mm256_unpacklo_epi8(first, g);     // [0-7 | 8-15]
+    __m256i hi01 = _mm256_unpackhi_epi8(first, g);     // [16-23 | 24-31]
+    __m256i lo23 = _mm256_unpacklo_epi8(third, alpha);
+    __m256i hi23 = _mm256_unpackhi_epi8(third, alpha);
+
+    __m256i p0 = _mm256_unpacklo_epi16(lo01, lo23);     // [0-3 | 8-11]
+    __m256i p1 = _mm256_unpackhi_epi16(lo01, lo23);     // [4-7 | 12-15]
+    __m256i p2 = _mm256_unpacklo_epi16(hi01, hi23);     // [16-19 | 24-27]
+    __m256i p3 = _mm256_unpackhi_epi16(hi01, hi23);     // [20-23 | 28-31]
+
+    __m256i *out = reinterpret_cast<__m256i *>(dst);
+    _mm256_storeu_si256(out + 0, _mm256_permute2x128_si256(p0, p1, 0x20));
+    _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(p0, p1, 0x31));
+    _mm256_storeu_si256(out + 2, _mm256_permute2x128_si256(p2, p3, 0x20));
+    _mm256_storeu_si256(out + 3, _mm256_permute2x128_si256(p2, p3, 0x31));
+}
+
+template<SrcLayout S, DstLayout D>
+YUV_TARGET_AVX2 void rowAvx2(const Coefficients &c, const uint8_t *yRow, const uint8_t *uRow,
+                             const uint8_t *vRow, uint8_t *dst, int width)
+{
+    typedef Layout<S> L;
+    const AvxCoefficients k = loadAvx(c);
+
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        __m256i y0, y1, u, v;
+        AvxLoad<S>::load(yRow, uRow, vRow, x, y0, y1, u, v);
+        u = _mm256_slli_epi16(_mm256_sub_epi16(u, k.uvOffset), L::chromaShift);
+        v = _mm256_slli_epi16(_mm256_sub_epi16(v, k.uvOffset), L::chromaShift);
+
+        // 通道内 unpack 前先把 64 位块排成 [0,2,1,3]，复制后色度与像素顺序一致
+        u = _mm256_permute4x64_epi64(u, 0xD8);
+        v = _mm256_permute4x64_epi64(v, 0xD8);
+
+        __m256i r0, g0, b0, r1, g1, b1;
+        pixelsAvx<L::lumaShift>(k, y0, _mm256_unpacklo_epi16(u, u), _mm256_unpacklo_epi16(v, v), r0, g0, b0);
+        pixelsAvx<L::lumaShift>(k, y1, _mm256_unpackhi_epi16(u, u), _mm256_unpackhi_epi16(v, v), r1, g1, b1);
+
+        storeAvx<D>(dst + x * 4, _mm256_packus_epi16(r0, r1), _mm256_packus_epi16(g0, g1),
+                    _mm256_packus_epi16(b0, b1));
+    }
+
+    rowScalar<S, D>(c, yRow, uRow, vRow, dst, x, width);
+}
+
+#endif // YUV_HAVE_X86
+
+typedef void (*RowFunction)(const Coefficients &, const uint8_t *, const uint8_t *,
+                            const uint8_t *, uint8_t *, int);
+
+template<SrcLayout S, DstLayout D>
+void rowScalarEntry(const Coefficients &c, const uint8_t *yRow, const uint8_t *uRow,
+                    const uint8_t *vRow, uint8_t *dst, int width)
+{
+    rowScalar<S, D>(c, yRow, uRow, vRow, dst, 0, width);
+}
+
+template<SrcLayout S, DstLayout D>
+RowFunction selectRow(YuvToRgbConverter::Kernel kernel)
+{
+#if YUV_HAVE_X86
+    switch (kernel) {
+    case YuvToRgbConverter::Kernel::Avx2:
+        return rowAvx2<S, D>;
+    case YuvToRgbConverter::Kernel::Sse41:
+        return rowSse41<S, D>;
+    default:
+        break;
+    }
+#else
+    (void)kernel;
+#endif
+    return rowScalarEntry<S, D>;
+}
+
+template<SrcLayout S>
+RowFunction selectRow(YuvToRgbConverter::Kernel kernel, DstLayout dst)
+{
+    return dst == DstLayout::Bgra ? selectRow<S, DstLayout::Bgra>(kernel)
+                                  : selectRow<S, DstLayout::Rgba>(kernel);
+}
+
+bool srcLayout(AVPixelFormat format, SrcLayout &layout)
+{
+    switch (format) {
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+        layout = SrcLayout::I420;
+        return true;
+    case AV_PIX_FMT_NV12:
+        layout = SrcLayout::NV12;
+        return true;
+    case AV_PIX_FMT_YUV420P10LE:
+        layout = SrcLayout::I010;
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool dstLayout(AVPixelFormat format, DstLayout &layout)
+{
+    switch (format) {
+    case AV_PIX_FMT_BGRA:
+    case AV_PIX_FMT_BGR0:
+        layout = DstLayout::Bgra;
+        return true;
+    case AV_PIX_FMT_RGBA:
+    case AV_PIX_FMT_RGB0:
+        layout = DstLayout::Rgba;
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+YuvToRgbConverter::YuvToRgbConverter(Kernel kernel)
+    : m_kernel(kernel)
+{
+}
+
+YuvToRgbConverter::Kernel YuvToRgbConverter::detectKernel()
+{
+#if YUV_HAVE_X86
+    // av_get_cpu_flags 已经检查过操作系统是否保存 AVX 寄存器
+    int flags = av_get_cpu_flags();
+    if (flags & AV_CPU_FLAG_AVX2) {
+        return Kernel::Avx2;
+    }
+    if (flags & AV_CPU_FLAG_SSE4) {
+        return Kernel::Sse41;
+    }
+#endif
+    return Kernel::Scalar;
+}
+
+const char *YuvToRgbConverter::kernelName(Kernel kernel)
+{
+    switch (kernel) {
+    case Kernel::Avx2:
+        return "avx2";
+    case Kernel::Sse41:
+        return "sse4.1";
+    default:
+        return "scalar";
+    }
+}
+
+bool YuvToRgbConverter::isSupported(AVPixelFormat srcFormat, AVPixelFormat dstFormat)
+{
+    SrcLayout src;
+    DstLayout dst;
+    return srcLayout(srcFormat, src) && dstLayout(dstFormat, dst);
+}
+
+bool YuvToRgbConverter::convert(const AVFrame *src, AVFrame *dst) const
+{
+    SrcLayout srcFmt;
+    DstLayout dstFmt;
+    if (!src || !dst || !srcLayout(static_cast<AVPixelFormat>(src->format), srcFmt)
+            || !dstLayout(static_cast<AVPixelFormat>(dst->format), dstFmt)) {
+        return false;
+    }
+    if (src->width != dst->width || src->height != dst->height) {
+        return false;
+    }
+
+    bool bt709 = src->colorspace == AVCOL_SPC_BT709;
+    bool fullRange = src->color_range == AVCOL_RANGE_JPEG || src->format == AV_PIX_FMT_YUVJ420P;
+
+    RowFunction row = nullptr;
+    Coefficients c;
+    switch (srcFmt) {
+    case SrcLayout::I420:
+        row = selectRow<SrcLayout::I420>(m_kernel, dstFmt);
+        c = makeCoefficients(8, bt709, fullRange);
+        break;
+    case SrcLayout::NV12:
+        row = selectRow<SrcLayout::NV12>(m_kernel, dstFmt);
+        c = makeCoefficients(8, bt709, fullRange);
+        break;
+    case SrcLayout::I010:
+        row = selectRow<SrcLayout::I010>(m_kernel, dstFmt);
+        c = makeCoefficients(10, bt709, fullRange);
+        break;
+    }
+
+    for (int y = 0; y < src->height; y++) {
+        const uint8_t *yRow = src->data[0] + y * src->linesize[0];
+        const uint8_t *uRow = src->data[1] + (y >> 1) * src->linesize[1];
+        const uint8_t *vRow = srcFmt == SrcLayout::NV12 ? uRow : src->data[2] + (y >> 1) * src->linesize[2];
+        row(c, yRow, uRow, vRow, dst->data[0] + y * dst->linesize[0], src->width);
+    }
+    return true;
+}
+
+YuvToRgbConverter::Kernel YuvToRgbConverter::kernel() const
+{
+    return m_kernel;
+}
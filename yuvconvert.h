@@ -0,0 +1,36 @@
+#ifndef YUVCONVERT_H
+#define YUVCONVERT_H
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+}
+
+// 手写的 YUV -> RGB32 转换内核（不缩放），支持 yuv420p/yuvj420p、nv12、yuv420p10
+// BT.601/BT.709，有限/全范围；运行时按 CPU 特性选择 AVX2、SSE4.1 或标量实现
+// 标量实现与 SIMD 实现逐位一致，作为测试参考；不支持的格式由调用方回退到 swscale
+class YuvToRgbConverter
+{
+public:
+    enum class Kernel {
+        Scalar,
+        Sse41,
+        Avx2
+    };
+
+    explicit YuvToRgbConverter(Kernel kernel = detectKernel());
+
+    static Kernel detectKernel();
+    static const char *kernelName(Kernel kernel);
+    static bool isSupported(AVPixelFormat srcFormat, AVPixelFormat dstFormat);
+
+    // src 与 dst 尺寸必须一致，色彩矩阵和范围取自 src 的 colorspace/color_range
+    bool convert(const AVFrame *src, AVFrame *dst) const;
+
+    Kernel kernel() const;
+
+private:
+    Kernel m_kernel;
+};
+
+#endif // YUVCONVERT_H